@@ -9,6 +9,12 @@
 #include <time.h>
 #include <cinttypes>
 
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #ifndef PRIu64
 #define PRIu64 "llu"
 #endif
@@ -19,10 +25,22 @@ AP_LoggerFileReader::AP_LoggerFileReader()
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (map != nullptr) {
+        munmap((void *)map, map_size);
+        ::close(fd);
+    }
+    free(time_index);
+#endif
 }
 
 bool AP_LoggerFileReader::open_log(const char *logfile)
 {
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (open_mapped(logfile)) {
+        return true;
+    }
+#endif
     fd = AP::FS().open(logfile, O_RDONLY);
     if (fd == -1) {
         return false;
@@ -32,11 +50,237 @@ bool AP_LoggerFileReader::open_log(const char *logfile)
 
 ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
 {
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (map != nullptr) {
+        const size_t ret = MIN(count, map_size - map_offset);
+        memcpy(buffer, &map[map_offset], ret);
+        map_offset += ret;
+        bytes_read += ret;
+        return ret;
+    }
+#endif
     uint64_t ret = AP::FS().read(fd, buffer, count);
     bytes_read += ret;
     return ret;
 }
 
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+/*
+  map the whole log into memory. Returns false if the log can't be
+  mapped, in which case it is read with the filesystem API instead
+ */
+bool AP_LoggerFileReader::open_mapped(const char *logfile)
+{
+    const int mfd = ::open(logfile, O_RDONLY|O_CLOEXEC);
+    if (mfd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(mfd, &st) != 0 || st.st_size <= 0) {
+        ::close(mfd);
+        return false;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, mfd, 0);
+    if (p == MAP_FAILED) {
+        ::close(mfd);
+        return false;
+    }
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    fd = mfd;
+    map = (const uint8_t *)p;
+    map_size = st.st_size;
+    map_offset = 0;
+    stop_offset = map_size;
+    return true;
+}
+
+/*
+  return the length of the message at offset, or zero if there is no
+  complete message of a known format there
+ */
+uint8_t AP_LoggerFileReader::msg_length(size_t offset) const
+{
+    if (offset + 3 > map_size) {
+        return 0;
+    }
+    const uint8_t *hdr = &map[offset];
+    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+        return 0;
+    }
+    const uint8_t length = hdr[2] == LOG_FORMAT_MSG ? sizeof(struct log_Format) : formats[hdr[2]].length;
+    if (length < 3 || offset + length > map_size) {
+        return 0;
+    }
+    return length;
+}
+
+bool AP_LoggerFileReader::msg_time_us(size_t offset, uint64_t &time_us) const
+{
+    if (offset + 3 + sizeof(time_us) > map_size || !has_time_us[map[offset+2]]) {
+        return false;
+    }
+    memcpy(&time_us, &map[offset+3], sizeof(time_us));
+    return true;
+}
+
+/*
+  walk the headers of all messages in the log, without handling them,
+  to find the formats, per-type counts and offsets and build a sparse
+  index from time to offset
+ */
+bool AP_LoggerFileReader::build_index()
+{
+    if (map == nullptr) {
+        return false;
+    }
+    if (indexed) {
+        return true;
+    }
+    memset(type_index, 0, sizeof(type_index));
+    time_index_len = 0;
+
+    size_t offset = 0;
+    uint64_t last_index_time_us = 0;
+    while (offset < map_size) {
+        const uint8_t length = msg_length(offset);
+        if (length == 0) {
+            // truncated or corrupt log; index what we have
+            break;
+        }
+        if (map[offset+2] == LOG_FORMAT_MSG) {
+            struct log_Format f;
+            memcpy(&f, &map[offset], sizeof(f));
+            set_format(f);
+        }
+        auto &t = type_index[map[offset+2]];
+        if (t.count == 0) {
+            t.first_offset = offset;
+        }
+        t.last_offset = offset;
+        t.count++;
+
+        uint64_t time_us;
+        if (msg_time_us(offset, time_us) &&
+            (time_index_len == 0 || time_us >= last_index_time_us + LOGREADER_TIME_INDEX_INTERVAL_US)) {
+            if (time_index_len == time_index_size) {
+                const uint32_t new_size = MAX(1024U, time_index_size * 2);
+                void *p = realloc(time_index, new_size * sizeof(time_index[0]));
+                if (p == nullptr) {
+                    return false;
+                }
+                time_index = (struct time_index_entry *)p;
+                time_index_size = new_size;
+            }
+            time_index[time_index_len++] = { time_us, offset };
+            last_index_time_us = time_us;
+        }
+        offset += length;
+    }
+    indexed = true;
+    return true;
+}
+
+/*
+  find the offset of the first message at or after time_us
+ */
+bool AP_LoggerFileReader::find_time_offset(uint64_t time_us, size_t &offset)
+{
+    if (!build_index() || time_index_len == 0) {
+        return false;
+    }
+    // find the last index entry before time_us
+    uint32_t lo = 0;
+    uint32_t hi = time_index_len;
+    while (hi - lo > 1) {
+        const uint32_t mid = (lo + hi) / 2;
+        if (time_index[mid].time_us < time_us) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t ofs = time_index[lo].offset;
+    uint8_t length;
+    while ((length = msg_length(ofs)) != 0) {
+        uint64_t t;
+        if (msg_time_us(ofs, t) && t >= time_us) {
+            offset = ofs;
+            return true;
+        }
+        ofs += length;
+    }
+    return false;
+}
+
+/*
+  move the read position to the first message at or after time_us
+ */
+bool AP_LoggerFileReader::seek_time(uint64_t time_us)
+{
+    size_t offset;
+    if (!find_time_offset(time_us, offset)) {
+        return false;
+    }
+    map_offset = offset;
+    return true;
+}
+
+/*
+  stop reading at the first message at or after time_us. A time after
+  the end of the log leaves the whole log to be read
+ */
+bool AP_LoggerFileReader::set_stop_time(uint64_t time_us)
+{
+    if (!build_index() || time_index_len == 0) {
+        return false;
+    }
+    if (!find_time_offset(time_us, stop_offset)) {
+        stop_offset = map_size;
+    }
+    return true;
+}
+
+/*
+  find the next message of type at or after offset
+ */
+const uint8_t *AP_LoggerFileReader::find_msg(uint8_t type, size_t &offset) const
+{
+    if (!indexed || type_index[type].count == 0) {
+        return nullptr;
+    }
+    offset = MAX(offset, type_index[type].first_offset);
+    uint8_t length;
+    while (offset <= type_index[type].last_offset && (length = msg_length(offset)) != 0) {
+        const uint8_t *msg = &map[offset];
+        offset += length;
+        if (msg[2] == type) {
+            return msg;
+        }
+    }
+    return nullptr;
+}
+
+bool AP_LoggerFileReader::find_type(const char *name, uint8_t &type) const
+{
+    if (!indexed) {
+        return false;
+    }
+    for (uint16_t i=0; i<LOGREADER_MAX_FORMATS; i++) {
+        if (formats[i].length != 0 && strncmp(formats[i].name, name, sizeof(formats[i].name)) == 0) {
+            type = i;
+            return true;
+        }
+    }
+    return false;
+}
+#endif // AP_LOGGERFILEREADER_MMAP_ENABLED
+
+void AP_LoggerFileReader::set_format(const struct log_Format &f)
+{
+    memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+    has_time_us[f.type] = f.format[0] == 'Q' && strncmp(f.labels, "TimeUS", 6) == 0;
+}
+
 void AP_LoggerFileReader::format_type(uint16_t type, char dest[5])
 {
     const struct log_Format &f = formats[type];
@@ -53,6 +297,11 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
 
 bool AP_LoggerFileReader::update()
 {
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (map != nullptr && map_offset >= stop_offset) {
+        return false;
+    }
+#endif
     uint8_t hdr[3];
     if (read_input(hdr, 3) != 3) {
         return false;
@@ -76,7 +325,7 @@ bool AP_LoggerFileReader::update()
         if (read_input(&f.type, sizeof(f)-3) != sizeof(f)-3) {
             return false;
         }
-        memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+        set_format(f);
 
         message_count++;
         return handle_log_format_msg(f);
@@ -2,7 +2,16 @@
 
 #include <AP_Logger/AP_Logger.h>
 
-#define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
+#define LOGREADER_MAX_FORMATS 256 // indexed by the uint8_t message type
+
+// on hosts with mmap the log is mapped into memory, which avoids a
+// read() per message and allows the log to be indexed and searched
+#ifndef AP_LOGGERFILEREADER_MMAP_ENABLED
+#define AP_LOGGERFILEREADER_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// minimum time between entries in the time index
+#define LOGREADER_TIME_INDEX_INTERVAL_US 100000
 
 class AP_LoggerFileReader
 {
@@ -20,6 +29,42 @@ public:
     void format_type(uint16_t type, char dest[5]);
     void get_packet_counts(uint64_t dest[]);
 
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    /*
+      indexed access to memory mapped logs. build_index() makes a
+      single pass over the message headers, recording all formats,
+      per-type message counts and offsets and a sparse time index
+     */
+    bool build_index();
+
+    // move the read position so that the next update() handles the
+    // first message at or after time_us
+    bool seek_time(uint64_t time_us);
+
+    // make update() stop before the first message at or after time_us
+    bool set_stop_time(uint64_t time_us);
+
+    // return the next message of type at or after offset, advancing
+    // offset past it. Returns nullptr when there are no more
+    const uint8_t *find_msg(uint8_t type, size_t &offset) const;
+
+    // find the type of the message called name, valid after build_index()
+    bool find_type(const char *name, uint8_t &type) const;
+
+    // number of messages of type in the log, valid after build_index()
+    uint32_t msg_count(uint8_t type) const {
+        return type_index[type].count;
+    }
+
+    // offset of the first message of type, valid after build_index()
+    size_t first_msg_offset(uint8_t type) const {
+        return type_index[type].first_offset;
+    }
+
+    // return true and fill time_us if the message at offset has a TimeUS field
+    bool msg_time_us(size_t offset, uint64_t &time_us) const;
+#endif
+
 protected:
     int fd = -1;
 
@@ -33,4 +78,36 @@ private:
     uint64_t start_micros;
 
     uint64_t packet_counts[LOGREADER_MAX_FORMATS] = {};
+
+    void set_format(const struct log_Format &f);
+
+    // true if the first field of the message type is a uint64_t TimeUS
+    bool has_time_us[LOGREADER_MAX_FORMATS] {};
+
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    bool open_mapped(const char *logfile);
+    // length of the message at offset, or zero if it is not a complete, known message
+    uint8_t msg_length(size_t offset) const;
+    // offset of the first message at or after time_us
+    bool find_time_offset(uint64_t time_us, size_t &offset);
+
+    const uint8_t *map = nullptr;
+    size_t map_size = 0;
+    size_t map_offset = 0;
+    size_t stop_offset = 0;
+
+    struct type_index_entry {
+        uint32_t count;
+        size_t first_offset;
+        size_t last_offset;
+    } type_index[LOGREADER_MAX_FORMATS] {};
+
+    struct time_index_entry {
+        uint64_t time_us;
+        size_t offset;
+    } *time_index = nullptr;
+    uint32_t time_index_len = 0;
+    uint32_t time_index_size = 0;
+    bool indexed = false;
+#endif
 };
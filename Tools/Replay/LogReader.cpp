@@ -134,10 +134,16 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
 }
 
 bool LogReader::handle_msg(const struct log_Format &f, uint8_t *msg) {
+    LR_MsgHandler *p = msgparser[f.type];
+    if (p == NULL && replay_dal_only) {
+        // only the messages the EKFs are replayed from are of
+        // interest, so don't spend time copying the rest of the log
+        return true;
+    }
+
     // emit the output as we receive it:
     AP::logger().WriteBlock(msg, f.length);
 
-    LR_MsgHandler *p = msgparser[f.type];
     if (p == NULL) {
         return true;
     }
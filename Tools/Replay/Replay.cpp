@@ -31,6 +31,17 @@
 #include <AP_HAL_Linux/Scheduler.h>
 #endif
 
+#if REPLAY_BATCH_ENABLED
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
 #define streq(x, y) (!strcmp(x, y))
 
 static ReplayVehicle replayvehicle;
@@ -39,6 +50,8 @@ static ReplayVehicle replayvehicle;
 user_parameter *user_parameters;
 bool replay_force_ekf2;
 bool replay_force_ekf3;
+bool replay_dal_only;
+float replay_stop_time_s;
 
 const AP_Param::Info ReplayVehicle::var_info[] = {
     GSCALAR(dummy,         "_DUMMY", 0),
@@ -133,11 +146,26 @@ void Replay::usage(void)
     ::printf("\t--param-file FILENAME  load parameters from a file\n");
     ::printf("\t--force-ekf2 force enable EKF2\n");
     ::printf("\t--force-ekf3 force enable EKF3\n");
+    ::printf("\t--dal-only only process and log replay (DAL) messages, for maximum speed\n");
+    ::printf("\t--stop-time SECONDS  stop replaying at this log time in seconds since boot\n");
+#if REPLAY_BATCH_ENABLED
+    ::printf("\t--jobs N  number of replay processes to run at once in batch mode\n");
+    ::printf("\t--param-set FILENAME  replay each log with this parameter file, may be repeated\n");
+    ::printf("\t--summary FILENAME  write the batch mode summary to a file instead of stdout\n");
+    ::printf("\t--result FILENAME  write the final EKF outputs to a file as CSV\n");
+    ::printf("Giving more than one log or any --param-set runs in batch mode, with\n");
+    ::printf("each log and parameter set combination replayed in its own directory\n");
+#endif
 }
 
 enum param_key : uint8_t {
     FORCE_EKF2 = 1,
     FORCE_EKF3,
+    DAL_ONLY,
+    STOP_TIME,
+    BATCH_PARAM_SET,
+    BATCH_SUMMARY,
+    BATCH_RESULT,
 };
 
 void Replay::_parse_command_line(uint8_t argc, char * const argv[])
@@ -149,11 +177,19 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"param-file",      true,   0, 'F'},
         {"force-ekf2",      false,  0, param_key::FORCE_EKF2},
         {"force-ekf3",      false,  0, param_key::FORCE_EKF3},
+        {"dal-only",        false,  0, param_key::DAL_ONLY},
+        {"stop-time",       true,   0, param_key::STOP_TIME},
+#if REPLAY_BATCH_ENABLED
+        {"jobs",            true,   0, 'j'},
+        {"param-set",       true,   0, param_key::BATCH_PARAM_SET},
+        {"summary",         true,   0, param_key::BATCH_SUMMARY},
+        {"result",          true,   0, param_key::BATCH_RESULT},
+#endif
         {"help",            false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "p:F:h", options);
+    GetOptLong gopt(argc, argv, "p:F:j:h", options);
 
     int opt;
     while ((opt = gopt.getoption()) != -1) {
@@ -184,6 +220,36 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             replay_force_ekf3 = true;
             break;
 
+        case param_key::DAL_ONLY:
+            replay_dal_only = true;
+            break;
+
+        case param_key::STOP_TIME:
+            replay_stop_time_s = atof(gopt.optarg);
+            break;
+
+#if REPLAY_BATCH_ENABLED
+        case 'j':
+            num_batch_jobs = constrain_int16(atoi(gopt.optarg), 1, REPLAY_BATCH_MAX_JOBS);
+            break;
+
+        case param_key::BATCH_PARAM_SET:
+            if (num_batch_param_sets >= ARRAY_SIZE(batch_param_sets)) {
+                ::printf("Too many parameter sets\n");
+                exit(1);
+            }
+            batch_param_sets[num_batch_param_sets++] = gopt.optarg;
+            break;
+
+        case param_key::BATCH_SUMMARY:
+            batch_summary_filename = gopt.optarg;
+            break;
+
+        case param_key::BATCH_RESULT:
+            result_filename = gopt.optarg;
+            break;
+#endif
+
         case 'h':
         default:
             usage();
@@ -197,6 +263,16 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
     if (argc > 0) {
         filename = argv[0];
     }
+
+#if REPLAY_BATCH_ENABLED
+    for (uint8_t i=0; i<argc; i++) {
+        if (num_batch_logs >= ARRAY_SIZE(batch_logs)) {
+            ::printf("Too many logs\n");
+            exit(1);
+        }
+        batch_logs[num_batch_logs++] = argv[i];
+    }
+#endif
 }
 
 void Replay::setup()
@@ -212,6 +288,16 @@ void Replay::setup()
         _parse_command_line(argc, argv);
     }
 
+#if REPLAY_BATCH_ENABLED
+    if (batch_mode()) {
+        const bool ok = run_batch();
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+        ((Linux::Scheduler*)hal.scheduler)->teardown();
+#endif
+        exit(ok ? 0 : 1);
+    }
+#endif
+
     _vehicle.setup();
 
     set_user_parameters();
@@ -242,11 +328,49 @@ void Replay::setup()
         ::printf("open(%s): %m\n", filename);
         exit(1);
     }
+    check_log();
+}
+
+/*
+  use the log index to check the log can be replayed and to apply the
+  stop time. Replay always starts at the beginning of the log as the
+  DAL only logs many of the EKF inputs when they change
+ */
+void Replay::check_log()
+{
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+    if (!reader.build_index()) {
+        if (replay_stop_time_s > 0) {
+            ::printf("--stop-time needs an indexed log\n");
+            exit(1);
+        }
+        return;
+    }
+    uint8_t frame_type;
+    if (!reader.find_type("RFRH", frame_type) || reader.msg_count(frame_type) == 0) {
+        ::printf("%s has no replay (DAL) frames, was it logged with LOG_REPLAY=1?\n", filename);
+    } else {
+        ::printf("%u replay frames\n", (unsigned)reader.msg_count(frame_type));
+    }
+    if (replay_stop_time_s > 0 &&
+        !reader.set_stop_time(uint64_t(replay_stop_time_s * 1.0e6))) {
+        ::printf("%s has no timestamps for --stop-time\n", filename);
+        exit(1);
+    }
+#else
+    if (replay_stop_time_s > 0) {
+        ::printf("--stop-time is not supported on this board\n");
+        exit(1);
+    }
+#endif
 }
 
 void Replay::loop()
 {
     if (!reader.update()) {
+#if REPLAY_BATCH_ENABLED
+        write_ekf_result();
+#endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
     // If we don't tear down the threads then they continue to access
     // global state during object destruction.
@@ -254,6 +378,9 @@ void Replay::loop()
 #endif
         exit(0);
     }
+#if REPLAY_BATCH_ENABLED
+    update_ekf_result();
+#endif
 }
 
 /*
@@ -322,6 +449,310 @@ void Replay::load_param_file(const char *pfilename)
     fclose(f);
 }
 
+#if REPLAY_BATCH_ENABLED
+/*
+  start a replay process for one log and parameter set combination,
+  running in its own directory so that the output log and storage of
+  each job do not collide
+ */
+pid_t Replay::start_batch_job(uint16_t job, const char *dirname)
+{
+    const uint8_t num_sets = MAX(num_batch_param_sets, 1);
+    const char *log = batch_logs[job / num_sets];
+    const char *param_set = num_batch_param_sets > 0 ? batch_param_sets[job % num_sets] : nullptr;
+
+    // paths must be absolute as the job runs in its own directory
+    char log_path[PATH_MAX];
+    char param_set_path[PATH_MAX];
+    if (realpath(log, log_path) == nullptr) {
+        ::printf("realpath(%s): %m\n", log);
+        return -1;
+    }
+    if (param_set != nullptr && realpath(param_set, param_set_path) == nullptr) {
+        ::printf("realpath(%s): %m\n", param_set);
+        return -1;
+    }
+    if (mkdir(dirname, 0755) != 0 && errno != EEXIST) {
+        ::printf("mkdir(%s): %m\n", dirname);
+        return -1;
+    }
+
+    // the parameter set is given first so it takes priority over
+    // parameters given on the command line
+    uint16_t num_params = 0;
+    for (const struct user_parameter *u=user_parameters; u; u=u->next) {
+        num_params++;
+    }
+    const char **child_argv = new const char *[2*num_params + 12];
+    char (*param_strings)[AP_MAX_NAME_SIZE+20] = new char[num_params][AP_MAX_NAME_SIZE+20];
+    if (child_argv == nullptr || param_strings == nullptr) {
+        delete[] child_argv;
+        delete[] param_strings;
+        return -1;
+    }
+    uint16_t n = 0;
+    child_argv[n++] = "Replay";
+    if (param_set != nullptr) {
+        child_argv[n++] = "--param-file";
+        child_argv[n++] = param_set_path;
+    }
+    // user_parameters is in reverse command line order
+    uint16_t i = num_params;
+    for (const struct user_parameter *u=user_parameters; u; u=u->next) {
+        i--;
+        snprintf(param_strings[i], sizeof(param_strings[i]), "%s=%.9g", u->name, (double)u->value);
+    }
+    for (i=0; i<num_params; i++) {
+        child_argv[n++] = "--parm";
+        child_argv[n++] = param_strings[i];
+    }
+    if (replay_force_ekf2) {
+        child_argv[n++] = "--force-ekf2";
+    }
+    if (replay_force_ekf3) {
+        child_argv[n++] = "--force-ekf3";
+    }
+    if (replay_dal_only) {
+        child_argv[n++] = "--dal-only";
+    }
+    char stop_time[20];
+    if (replay_stop_time_s > 0) {
+        snprintf(stop_time, sizeof(stop_time), "%.6f", (double)replay_stop_time_s);
+        child_argv[n++] = "--stop-time";
+        child_argv[n++] = stop_time;
+    }
+    child_argv[n++] = "--result";
+    child_argv[n++] = "replay.result";
+    child_argv[n++] = log_path;
+    child_argv[n] = nullptr;
+
+    // stdio is mapped to AP_Filesystem in this file, so the console
+    // is redirected with file descriptors
+    const pid_t pid = fork();
+    if (pid == 0) {
+        // keep the console output of each job with its output log
+        int fd;
+        if (chdir(dirname) != 0 ||
+            (fd = ::open("replay.out", O_WRONLY|O_CREAT|O_TRUNC, 0644)) == -1 ||
+            dup2(fd, STDOUT_FILENO) == -1 ||
+            dup2(fd, STDERR_FILENO) == -1) {
+            _exit(1);
+        }
+        execv("/proc/self/exe", (char * const *)child_argv);
+        _exit(1);
+    }
+
+    delete[] child_argv;
+    delete[] param_strings;
+    return pid;
+}
+
+// EKF result columns of the batch summary, see write_ekf_result()
+#define REPLAY_RESULT_HEADER "ekf,healthy,max_vel_var,max_pos_var,max_hgt_var,max_mag_var,pos_n,pos_e,pos_d,roll,pitch,yaw"
+#define REPLAY_RESULT_EMPTY ",,,,,,,,,,,"
+
+/*
+  track the peak EKF variances of the running EKF over the replay
+ */
+void Replay::update_ekf_result()
+{
+    if (result_filename == nullptr) {
+        return;
+    }
+    float velVar, posVar, hgtVar, tasVar;
+    Vector3f magVar;
+    Vector2f offset;
+    bool have_variances;
+    if (_vehicle.ekf3.activeCores() > 0) {
+        ekf_result.ekf_type = 3;
+        have_variances = _vehicle.ekf3.getVariances(velVar, posVar, hgtVar, magVar, tasVar, offset);
+    } else if (_vehicle.ekf2.activeCores() > 0) {
+        ekf_result.ekf_type = 2;
+        have_variances = _vehicle.ekf2.getVariances(velVar, posVar, hgtVar, magVar, tasVar, offset);
+    } else {
+        return;
+    }
+    if (!have_variances) {
+        return;
+    }
+    ekf_result.max_vel_var = MAX(ekf_result.max_vel_var, velVar);
+    ekf_result.max_pos_var = MAX(ekf_result.max_pos_var, posVar);
+    ekf_result.max_hgt_var = MAX(ekf_result.max_hgt_var, hgtVar);
+    ekf_result.max_mag_var = MAX(ekf_result.max_mag_var, magVar.length());
+}
+
+template <typename EKF>
+static void get_ekf_state(const EKF &ekf, bool &healthy, Vector2f &posNE, float &posD, Vector3f &euler)
+{
+    healthy = ekf.healthy();
+    ekf.getPosNE(posNE);
+    ekf.getPosD(posD);
+    ekf.getEulerAngles(euler);
+}
+
+/*
+  write the EKF outputs at the end of the replay as one CSV line
+  matching REPLAY_RESULT_HEADER
+ */
+void Replay::write_ekf_result()
+{
+    if (result_filename == nullptr) {
+        return;
+    }
+    bool healthy = false;
+    Vector2f posNE;
+    float posD = 0;
+    Vector3f euler;
+    if (ekf_result.ekf_type == 3) {
+        get_ekf_state(_vehicle.ekf3, healthy, posNE, posD, euler);
+    } else if (ekf_result.ekf_type == 2) {
+        get_ekf_state(_vehicle.ekf2, healthy, posNE, posD, euler);
+    }
+    const int fd = ::open(result_filename, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd == -1) {
+        ::printf("open(%s): %m\n", result_filename);
+        return;
+    }
+    dprintf(fd, "%u,%u,%.6g,%.6g,%.6g,%.6g,%.3f,%.3f,%.3f,%.2f,%.2f,%.2f\n",
+            unsigned(ekf_result.ekf_type),
+            unsigned(healthy),
+            (double)ekf_result.max_vel_var,
+            (double)ekf_result.max_pos_var,
+            (double)ekf_result.max_hgt_var,
+            (double)ekf_result.max_mag_var,
+            (double)posNE.x,
+            (double)posNE.y,
+            (double)posD,
+            (double)degrees(euler.x),
+            (double)degrees(euler.y),
+            (double)wrap_360(degrees(euler.z)));
+    ::close(fd);
+}
+
+/*
+  read the EKF result line written by a batch job, or the empty
+  columns if the job did not write one
+ */
+static void read_ekf_result(uint16_t job, char *result, size_t size)
+{
+    char path[40];
+    snprintf(path, sizeof(path), "replay_job%u/replay.result", unsigned(job));
+    strncpy(result, REPLAY_RESULT_EMPTY, size);
+    const int fd = ::open(path, O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    const ssize_t n = ::read(fd, result, size-1);
+    ::close(fd);
+    if (n <= 0) {
+        strncpy(result, REPLAY_RESULT_EMPTY, size);
+        return;
+    }
+    result[n] = 0;
+    char *nl = strchr(result, '\n');
+    if (nl != nullptr) {
+        *nl = 0;
+    }
+}
+
+/*
+  replay each log against each parameter set, running up to
+  num_batch_jobs replay processes at once. A summary line with the
+  final EKF outputs is written as each job completes. Returns false
+  if any job failed
+ */
+bool Replay::run_batch()
+{
+    const uint8_t num_sets = MAX(num_batch_param_sets, 1);
+    const uint16_t num_jobs = num_batch_logs * num_sets;
+
+    // stdio is mapped to AP_Filesystem in this file, so the summary
+    // is written with a file descriptor
+    int summary = STDOUT_FILENO;
+    if (batch_summary_filename != nullptr) {
+        summary = ::open(batch_summary_filename, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+        if (summary == -1) {
+            ::printf("open(%s): %m\n", batch_summary_filename);
+            return false;
+        }
+    }
+    dprintf(summary, "job,log,param_set,directory,exit_status,seconds," REPLAY_RESULT_HEADER "\n");
+
+    struct {
+        pid_t pid;
+        uint16_t job;
+        struct timespec start;
+    } running[REPLAY_BATCH_MAX_JOBS] {};
+    uint8_t num_running = 0;
+    uint16_t next_job = 0;
+    uint16_t num_failed = 0;
+
+    while (next_job < num_jobs || num_running > 0) {
+        while (next_job < num_jobs && num_running < num_batch_jobs) {
+            char dirname[20];
+            snprintf(dirname, sizeof(dirname), "replay_job%u", unsigned(next_job));
+            auto &r = running[num_running];
+            clock_gettime(CLOCK_MONOTONIC, &r.start);
+            r.pid = start_batch_job(next_job, dirname);
+            r.job = next_job++;
+            if (r.pid == -1) {
+                dprintf(summary, "%u,%s,%s,%s,start_failed,0," REPLAY_RESULT_EMPTY "\n",
+                        unsigned(r.job),
+                        batch_logs[r.job / num_sets],
+                        num_batch_param_sets > 0 ? batch_param_sets[r.job % num_sets] : "",
+                        dirname);
+                num_failed++;
+                continue;
+            }
+            num_running++;
+        }
+        if (num_running == 0) {
+            break;
+        }
+
+        int status;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (uint8_t i=0; i<num_running; i++) {
+            if (running[i].pid != pid) {
+                continue;
+            }
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            const double seconds = (now.tv_sec - running[i].start.tv_sec) +
+                (now.tv_nsec - running[i].start.tv_nsec) * 1.0e-9;
+            const int exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            if (exit_status != 0) {
+                num_failed++;
+            }
+            char result[200];
+            read_ekf_result(running[i].job, result, sizeof(result));
+            dprintf(summary, "%u,%s,%s,replay_job%u,%d,%.3f,%s\n",
+                    unsigned(running[i].job),
+                    batch_logs[running[i].job / num_sets],
+                    num_batch_param_sets > 0 ? batch_param_sets[running[i].job % num_sets] : "",
+                    unsigned(running[i].job),
+                    exit_status,
+                    seconds,
+                    result);
+            running[i] = running[--num_running];
+            break;
+        }
+    }
+
+    if (summary != STDOUT_FILENO) {
+        ::close(summary);
+    }
+    ::printf("Replayed %u jobs, %u failed\n", unsigned(num_jobs), unsigned(num_failed));
+    return num_failed == 0;
+}
+#endif // REPLAY_BATCH_ENABLED
+
 Replay replay(replayvehicle);
 AP_Vehicle& vehicle = replayvehicle;
 
@@ -18,6 +18,8 @@
 
 #include "LogReader.h"
 
+#include <sys/types.h>
+
 #define AP_PARAM_VEHICLE_NAME replayvehicle
 
 struct user_parameter {
@@ -29,6 +31,20 @@ struct user_parameter {
 extern user_parameter *user_parameters;
 extern bool replay_force_ekf2;
 extern bool replay_force_ekf3;
+extern bool replay_dal_only;
+extern float replay_stop_time_s;
+
+// batch mode replays several logs and/or parameter sets in worker
+// processes. Workers are started from /proc/self/exe, so this is
+// Linux only
+#if (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX) && defined(__linux__)
+#define REPLAY_BATCH_ENABLED 1
+#else
+#define REPLAY_BATCH_ENABLED 0
+#endif
+#define REPLAY_BATCH_MAX_LOGS 256
+#define REPLAY_BATCH_MAX_PARAM_SETS 64
+#define REPLAY_BATCH_MAX_JOBS 64
 
 class ReplayVehicle : public AP_Vehicle {
 public:
@@ -90,9 +106,39 @@ private:
     LogReader reader{_vehicle.log_structure, _vehicle.ekf2, _vehicle.ekf3};
 
     void _parse_command_line(uint8_t argc, char * const argv[]);
+    void check_log();
 
     void set_user_parameters(void);
     bool parse_param_line(char *line, char **vname, float &value);
     void load_param_file(const char *filename);
     void usage();
+
+#if REPLAY_BATCH_ENABLED
+    // logs and parameter sets to be replayed in batch mode
+    const char *batch_logs[REPLAY_BATCH_MAX_LOGS];
+    uint16_t num_batch_logs;
+    const char *batch_param_sets[REPLAY_BATCH_MAX_PARAM_SETS];
+    uint8_t num_batch_param_sets;
+    uint8_t num_batch_jobs = 1;
+    const char *batch_summary_filename;
+
+    bool batch_mode() const {
+        return num_batch_logs > 1 || num_batch_param_sets > 0;
+    }
+    bool run_batch();
+    pid_t start_batch_job(uint16_t job, const char *dirname);
+
+    // EKF outputs written to result_filename when the replay ends,
+    // for the batch mode summary
+    const char *result_filename;
+    struct {
+        uint8_t ekf_type;
+        float max_vel_var;
+        float max_pos_var;
+        float max_hgt_var;
+        float max_mag_var;
+    } ekf_result;
+    void update_ekf_result();
+    void write_ekf_result();
+#endif
 };
@@ -0,0 +1,212 @@
+#include <AP_gtest.h>
+#include "../DataFlashFileReader.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_LOGGERFILEREADER_MMAP_ENABLED
+
+static const char *log_file = "test_log_index.bin";
+
+enum test_msg_type : uint8_t {
+    TYPE_TIMED = 1,     // has a TimeUS field
+    TYPE_SLOW = 2,      // has a TimeUS field, written at 1Hz
+    TYPE_UNTIMED = 3,   // no TimeUS field
+};
+
+struct PACKED log_Timed {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t n;
+};
+
+struct PACKED log_Untimed {
+    LOG_PACKET_HEADER;
+    uint32_t n;
+};
+
+/*
+  records the messages handled by update()
+ */
+class TestReader : public AP_LoggerFileReader {
+public:
+    bool handle_log_format_msg(const struct log_Format &f) override {
+        return true;
+    }
+    bool handle_msg(const struct log_Format &f, uint8_t *msg) override {
+        last_type = f.type;
+        if (f.type != TYPE_UNTIMED) {
+            memcpy(&last_time_us, &msg[3], sizeof(last_time_us));
+        }
+        handled++;
+        return true;
+    }
+    uint8_t last_type;
+    uint64_t last_time_us;
+    uint32_t handled;
+};
+
+static void write_format(FILE *f, uint8_t type, uint8_t length, const char *name, const char *format, const char *labels)
+{
+    struct log_Format fmt {};
+    fmt.head1 = HEAD_BYTE1;
+    fmt.head2 = HEAD_BYTE2;
+    fmt.msgid = LOG_FORMAT_MSG;
+    fmt.type = type;
+    fmt.length = length;
+    strncpy(fmt.name, name, sizeof(fmt.name));
+    strncpy(fmt.format, format, sizeof(fmt.format));
+    strncpy(fmt.labels, labels, sizeof(fmt.labels));
+    fwrite(&fmt, sizeof(fmt), 1, f);
+}
+
+static void write_timed(FILE *f, uint8_t type, uint64_t time_us, uint32_t n)
+{
+    const struct log_Timed pkt {
+        LOG_PACKET_HEADER_INIT(type),
+        time_us : time_us,
+        n       : n,
+    };
+    fwrite(&pkt, sizeof(pkt), 1, f);
+}
+
+/*
+  10s of messages at 100Hz, with a 1Hz message and an untimed message
+  every 10th message
+ */
+static void write_test_log()
+{
+    FILE *f = fopen(log_file, "w");
+    ASSERT_NE(f, nullptr);
+    write_format(f, TYPE_TIMED, sizeof(log_Timed), "TIMD", "QI", "TimeUS,N");
+    write_format(f, TYPE_SLOW, sizeof(log_Timed), "SLOW", "QI", "TimeUS,N");
+    write_format(f, TYPE_UNTIMED, sizeof(log_Untimed), "UNTM", "I", "N");
+    for (uint32_t i=0; i<1000; i++) {
+        const uint64_t time_us = 1000000ULL + i*10000ULL;
+        write_timed(f, TYPE_TIMED, time_us, i);
+        if (i % 100 == 0) {
+            write_timed(f, TYPE_SLOW, time_us, i/100);
+        }
+        if (i % 10 == 0) {
+            const struct log_Untimed pkt {
+                LOG_PACKET_HEADER_INIT(TYPE_UNTIMED),
+                n : i/10,
+            };
+            fwrite(&pkt, sizeof(pkt), 1, f);
+        }
+    }
+    fclose(f);
+}
+
+// one pass over the log finds the formats and per-type counts
+TEST(LogIndex, TypeCounts)
+{
+    write_test_log();
+    TestReader reader;
+    ASSERT_TRUE(reader.open_log(log_file));
+    ASSERT_TRUE(reader.build_index());
+
+    uint8_t type;
+    ASSERT_TRUE(reader.find_type("TIMD", type));
+    EXPECT_EQ(type, TYPE_TIMED);
+    ASSERT_TRUE(reader.find_type("SLOW", type));
+    EXPECT_EQ(type, TYPE_SLOW);
+    EXPECT_FALSE(reader.find_type("NONE", type));
+
+    EXPECT_EQ(reader.msg_count(TYPE_TIMED), 1000U);
+    EXPECT_EQ(reader.msg_count(TYPE_SLOW), 10U);
+    EXPECT_EQ(reader.msg_count(TYPE_UNTIMED), 100U);
+    EXPECT_EQ(reader.msg_count(LOG_FORMAT_MSG), 3U);
+    EXPECT_EQ(reader.first_msg_offset(TYPE_TIMED), 3*sizeof(struct log_Format));
+
+    uint64_t time_us;
+    EXPECT_TRUE(reader.msg_time_us(reader.first_msg_offset(TYPE_SLOW), time_us));
+    EXPECT_EQ(time_us, 1000000U);
+    EXPECT_FALSE(reader.msg_time_us(reader.first_msg_offset(TYPE_UNTIMED), time_us));
+
+    // the index was built without handling any messages
+    EXPECT_EQ(reader.handled, 0U);
+    unlink(log_file);
+}
+
+// find_msg() walks the messages of one type in order
+TEST(LogIndex, FindMsg)
+{
+    write_test_log();
+    TestReader reader;
+    ASSERT_TRUE(reader.open_log(log_file));
+    ASSERT_TRUE(reader.build_index());
+
+    size_t offset = 0;
+    uint32_t count = 0;
+    const uint8_t *msg;
+    while ((msg = reader.find_msg(TYPE_SLOW, offset)) != nullptr) {
+        struct log_Timed pkt;
+        memcpy(&pkt, msg, sizeof(pkt));
+        EXPECT_EQ(pkt.msgid, TYPE_SLOW);
+        EXPECT_EQ(pkt.n, count);
+        EXPECT_EQ(pkt.time_us, 1000000ULL + count*1000000ULL);
+        count++;
+    }
+    EXPECT_EQ(count, 10U);
+    unlink(log_file);
+}
+
+// seek_time() starts update() at the first message at or after a time
+TEST(LogIndex, SeekTime)
+{
+    write_test_log();
+    TestReader reader;
+    ASSERT_TRUE(reader.open_log(log_file));
+
+    ASSERT_TRUE(reader.seek_time(5555000));
+    ASSERT_TRUE(reader.update());
+    EXPECT_EQ(reader.last_type, TYPE_TIMED);
+    EXPECT_EQ(reader.last_time_us, 5560000U);
+
+    // an exact match on a message also written at 1Hz
+    ASSERT_TRUE(reader.seek_time(3000000));
+    ASSERT_TRUE(reader.update());
+    EXPECT_EQ(reader.last_type, TYPE_TIMED);
+    EXPECT_EQ(reader.last_time_us, 3000000U);
+    ASSERT_TRUE(reader.update());
+    EXPECT_EQ(reader.last_type, TYPE_SLOW);
+    EXPECT_EQ(reader.last_time_us, 3000000U);
+
+    // past the end of the log
+    EXPECT_FALSE(reader.seek_time(20000000));
+    unlink(log_file);
+}
+
+// set_stop_time() ends update() before the first message at the stop time
+TEST(LogIndex, StopTime)
+{
+    write_test_log();
+    TestReader reader;
+    ASSERT_TRUE(reader.open_log(log_file));
+    ASSERT_TRUE(reader.set_stop_time(2000000));
+
+    uint32_t timed = 0;
+    while (reader.update()) {
+        if (reader.last_type == TYPE_TIMED) {
+            timed++;
+            EXPECT_LT(reader.last_time_us, 2000000U);
+        }
+    }
+    EXPECT_EQ(timed, 100U);
+
+    // a stop time after the end of the log reads the whole log
+    TestReader reader2;
+    ASSERT_TRUE(reader2.open_log(log_file));
+    ASSERT_TRUE(reader2.set_stop_time(20000000));
+    while (reader2.update()) {
+    }
+    EXPECT_EQ(reader2.handled, 1000U + 10U + 100U);
+    unlink(log_file);
+}
+
+#endif // AP_LOGGERFILEREADER_MMAP_ENABLED
+
+AP_GTEST_MAIN()
@@ -9320,11 +9320,15 @@ class AutoTestCopter(AutoTest):
 
         lines = content.split("\n")
 
-        if not lines[0].startswith("TasksV2"):
-            raise NotAchievedException("Expected TasksV2 as first line first not (%s)" % lines[0])
-        # last line is empty, so -2 here
-        if not lines[-2].startswith("AP_Vehicle::update_arming"):
-            raise NotAchievedException("Expected EFI last not (%s)" % lines[-2])
+        if not lines[0].startswith("TasksV3"):
+            raise NotAchievedException("Expected TasksV3 as first line first not (%s)" % lines[0])
+        if " P99=" not in lines[1]:
+            raise NotAchievedException("Expected task percentiles not (%s)" % lines[1])
+        # last line is empty, and the harmonic notch sub-measurement
+        # of the INS task follows the tasks when a notch is enabled
+        task_lines = [x for x in lines[:-1] if not x.startswith("AP_InertialSensor::update:notch")]
+        if not task_lines[-1].startswith("AP_Vehicle::update_arming"):
+            raise NotAchievedException("Expected EFI last not (%s)" % task_lines[-1])
 
     def RTL_TO_RALLY(self, target_system=1, target_component=1):
         '''Check RTL to rally point'''
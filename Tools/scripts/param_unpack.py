@@ -15,10 +15,11 @@ data = open(args.file,'rb').read()
 last_name = ""
 
 magic = 0x671b
+magic_with_defaults = 0x671c
 
 # header of 6 bytes
 magic2,num_params,total_params = struct.unpack("<HHH", data[0:6])
-if magic != magic2:
+if magic2 not in [magic, magic_with_defaults]:
     print("Bad magic 0x%x expected 0x%x" % (magic2, magic))
     sys.exit(1)
 
@@ -66,8 +67,15 @@ while True:
     last_name = name
     data = data[2+name_len+type_len:]
     v, = struct.unpack("<" + type_format, vdata)
+    if flags & 1:
+        # default value follows the value
+        default, = struct.unpack("<" + type_format, data[0:type_len])
+        data = data[type_len:]
     count += 1
-    print("%-16s %f" % (name, float(v)))
+    if flags & 1:
+        print("%-16s %f (default %f)" % (name, float(v), float(default)))
+    else:
+        print("%-16s %f" % (name, float(v)))
 
 if count != num_params or count > total_params:
     print("Error: Got %u params expected %u/%u" % (count, num_params, total_params))
@@ -59,6 +59,12 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
     r.file_ofs = 0;
     r.open = true;
     r.with_defaults = false;
+    r.non_default = false;
+    r.compact = false;
+    r.unchanged = false;
+    r.num_params = 0;
+    r.send_map_bits = 0;
+    r.send_map = nullptr;
     r.start = 0;
     r.count = 0;
     r.read_size = 0;
@@ -77,6 +83,8 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
     /*
       allow for URI style arguments param.pck?start=N&count=C
      */
+    bool have_crc = false;
+    uint32_t client_crc = 0;
     const char *c = strchr(fname, '?');
     while (c && *c) {
         c++;
@@ -111,13 +119,63 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
             c = strchr(c, '&');
             continue;
         }
+        if (strncmp(c, "nondefault=", 11) == 0) {
+            uint32_t v = strtoul(c+11, nullptr, 10);
+            if (v > 1) {
+                goto failed;
+            }
+            r.non_default = v == 1;
+            c += 11;
+            c = strchr(c, '&');
+            continue;
+        }
 #endif
+        if (strncmp(c, "compact=", 8) == 0) {
+            uint32_t v = strtoul(c+8, nullptr, 10);
+            if (v > 1) {
+                goto failed;
+            }
+            r.compact = v == 1;
+            c += 8;
+            c = strchr(c, '&');
+            continue;
+        }
+        if (strncmp(c, "crc=", 4) == 0) {
+            client_crc = strtoul(c+4, nullptr, 16);
+            have_crc = true;
+            c += 4;
+            c = strchr(c, '&');
+            continue;
+        }
+    }
+
+    if (read_only && r.non_default) {
+        // the set of parameters sent is fixed at open so that
+        // re-reads of lost blocks always see the same layout
+        const uint16_t total = AP_Param::count_parameters();
+        uint16_t n = total > r.start ? total - r.start : 0;
+        if (r.count > 0) {
+            n = MIN(n, r.count);
+        }
+        r.send_map = new uint8_t[(n+7)/8];
+        if (r.send_map == nullptr) {
+            close(idx);
+            errno = ENOMEM;
+            return -1;
+        }
+        r.send_map_bits = n;
+    }
+    if (read_only && (have_crc || r.non_default)) {
+        r.unchanged = have_crc && scan_params(r) == client_crc;
     }
 
     return idx;
 
 failed:
     delete [] r.cursors;
+    r.cursors = nullptr;
+    delete r.writebuf;
+    r.writebuf = nullptr;
     r.open = false;
     errno = EINVAL;
     return -1;
@@ -140,6 +198,8 @@ int AP_Filesystem_Param::close(int fd)
     r.cursors = nullptr;
     delete r.writebuf;
     r.writebuf = nullptr;
+    delete [] r.send_map;
+    r.send_map = nullptr;
     return ret;
 }
 
@@ -159,10 +219,107 @@ int AP_Filesystem_Param::close(int fd)
     uint8_t name[name_len]; // name
     uint8_t data[];         // value, length given by variable type, data length doubled if default is included
 
+    flags bit 1 is set in compact mode when a float parameter is sent
+    as the INT8 or INT16 type because its value, and its default if
+    included, are integers in range of that type.
+
     Any leading zero bytes after the header should be discarded as pad
     bytes. Pad bytes are used to ensure that a parameter data[] field
     does not cross a read packet boundary
+
+    When the client gives the CRC of its copy of the parameters and
+    it matches, num_params in the header is zero and no parameters
+    follow. The CRC is the crc32 over, for each parameter the file
+    would contain, its null terminated name, its AP_Param type byte
+    and its value bytes
+ */
+
+/*
+  return true if a parameter is left out of the file
  */
+bool AP_Filesystem_Param::skip_param(const struct rfile &r, AP_Param *ap, enum ap_var_type ptype, float default_val) const
+{
+#if AP_PARAM_DEFAULTS_ENABLED
+    return r.non_default && is_equal(ap->cast_to_float(ptype), default_val);
+#else
+    return false;
+#endif
+}
+
+/*
+  return true if the parameter at index idx from the start of the file
+  range was selected to be sent at open
+ */
+bool AP_Filesystem_Param::param_selected(const struct rfile &r, uint16_t idx) const
+{
+    if (r.send_map == nullptr) {
+        return true;
+    }
+    if (idx >= r.send_map_bits) {
+        return false;
+    }
+    return (r.send_map[idx/8] & (1U<<(idx%8))) != 0;
+}
+
+/*
+  a pass over the parameters in the file, selecting and counting those
+  to be sent and returning the CRC of their values for the snapshot
+  check
+ */
+uint32_t AP_Filesystem_Param::scan_params(struct rfile &r)
+{
+    AP_Param::ParamToken token;
+    enum ap_var_type ptype;
+    float default_val;
+    uint32_t crc = 0;
+    uint16_t idx = 0;
+
+    r.num_params = 0;
+    for (AP_Param *ap = AP_Param::first(&token, &ptype, &default_val);
+         ap != nullptr && (r.count == 0 || idx < r.start + r.count);
+         ap = AP_Param::next_scalar(&token, &ptype, &default_val), idx++) {
+        if (idx < r.start) {
+            continue;
+        }
+        const uint16_t map_idx = idx - r.start;
+        if (r.send_map != nullptr) {
+            if (map_idx >= r.send_map_bits) {
+                break;
+            }
+            if (skip_param(r, ap, ptype, default_val)) {
+                r.send_map[map_idx/8] &= ~(1U<<(map_idx%8));
+                continue;
+            }
+            r.send_map[map_idx/8] |= (1U<<(map_idx%8));
+        }
+        // only the parameters which are sent are in the CRC, so the
+        // client can calculate it from what it received
+        char name[AP_MAX_NAME_SIZE+1];
+        ap->copy_name_token(token, name, AP_MAX_NAME_SIZE, true);
+        name[AP_MAX_NAME_SIZE] = 0;
+        const uint8_t type = uint8_t(ptype);
+        crc = crc_crc32(crc, (const uint8_t *)name, strlen(name)+1);
+        crc = crc_crc32(crc, &type, 1);
+        crc = crc_crc32(crc, (const uint8_t *)ap, AP_Param::type_size(ptype));
+        r.num_params++;
+    }
+    return crc;
+}
+
+/*
+  return the smallest integer type which holds v exactly, or
+  AP_PARAM_FLOAT if there isn't one smaller than a float
+ */
+static enum ap_var_type compact_type(float v)
+{
+    if (!(fabsf(v) <= INT16_MAX) || v != float(int16_t(v))) {
+        return AP_PARAM_FLOAT;
+    }
+    if (v >= INT8_MIN && v <= INT8_MAX) {
+        return AP_PARAM_INT8;
+    }
+    return AP_PARAM_INT16;
+}
 
 /*
   pack a single parameter. The buffer must be at least of size max_pack_len
@@ -175,6 +332,10 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
     AP_Param *ap;
     float default_val;
 
+    if (r.unchanged) {
+        return 0;
+    }
+
     if (c.token_ofs == 0) {
         c.idx = 0;
         ap = AP_Param::first(&c.token, &ptype, &default_val);
@@ -187,6 +348,11 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
         c.idx++;
         ap = AP_Param::next_scalar(&c.token, &ptype, &default_val);
     }
+    while (ap != nullptr && !(r.count && c.idx >= r.count) &&
+           !param_selected(r, c.idx)) {
+        c.idx++;
+        ap = AP_Param::next_scalar(&c.token, &ptype, &default_val);
+    }
     if (ap == nullptr || (r.count && c.idx >= r.count)) {
         if (r.count == 0 && c.idx != AP_Param::count_parameters()) {
             // the parameter count is incorrect, invalidate so a
@@ -216,9 +382,38 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
 #else
     const bool add_default = false;
 #endif
+
+    // the value as sent, which in compact mode may be a float
+    // narrowed to an integer type
+    union {
+        int8_t i8;
+        int16_t i16;
+        uint8_t bytes[4];
+    } value;
+    bool narrowed = false;
+    if (r.compact && ptype == AP_PARAM_FLOAT) {
+        const float v = ((AP_Float *)ap)->get();
+        enum ap_var_type vtype = compact_type(v);
+        if (add_default) {
+            vtype = MAX(vtype, compact_type(default_val));
+        }
+        if (vtype != AP_PARAM_FLOAT) {
+            narrowed = true;
+            ptype = vtype;
+            if (vtype == AP_PARAM_INT8) {
+                value.i8 = v;
+            } else {
+                value.i16 = v;
+            }
+        }
+    }
+    if (!narrowed) {
+        memcpy(value.bytes, ap, AP_Param::type_size(ptype));
+    }
+
     const uint8_t type_len = AP_Param::type_size(ptype);
     uint8_t packed_len = type_len + name_len + 2 + (add_default ? type_len : 0);
-    const uint8_t flags = add_default;
+    const uint8_t flags = add_default | (narrowed ? 2 : 0);
 
     /*
       see if we need to add padding to ensure that a data field never
@@ -239,7 +434,7 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
     buf[0] = uint8_t(ptype) | (flags<<4);
     buf[1] = common_len | ((name_len-1)<<4);
     memcpy(&buf[2], pname, name_len);
-    memcpy(&buf[2+name_len], ap, type_len);
+    memcpy(&buf[2+name_len], value.bytes, type_len);
 #if AP_PARAM_DEFAULTS_ENABLED
     if (add_default) {
         switch (ptype) {
@@ -364,6 +559,11 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
         if (r.count > 0 && hdr.num_params > r.count) {
             hdr.num_params = r.count;
         }
+        if (r.unchanged) {
+            hdr.num_params = 0;
+        } else if (r.non_default) {
+            hdr.num_params = r.num_params;
+        }
         uint8_t n = MIN(sizeof(hdr) - r.file_ofs, count);
         if (r.with_defaults) {
             hdr.magic = pmagic_with_default;
@@ -69,6 +69,12 @@ private:
     struct rfile {
         bool open;
         bool with_defaults;
+        bool non_default; // only send parameters which differ from their defaults
+        bool compact;     // send float values as smaller integer types where exact
+        bool unchanged;   // parameters match the client's snapshot CRC, send none
+        uint16_t num_params; // number of parameters sent when non_default
+        uint16_t send_map_bits; // number of parameters covered by send_map
+        uint8_t *send_map;   // when non_default, bit per parameter from start which is sent
         uint16_t read_size;
         uint16_t start;
         uint16_t count;
@@ -80,6 +86,9 @@ private:
 
     bool token_seek(const struct rfile &r, const uint32_t data_ofs, struct cursor &c);
     uint8_t pack_param(const struct rfile &r, struct cursor &c, uint8_t *buf);
+    bool skip_param(const struct rfile &r, AP_Param *ap, enum ap_var_type ptype, float default_val) const;
+    bool param_selected(const struct rfile &r, uint16_t idx) const;
+    uint32_t scan_params(struct rfile &r);
     bool check_file_name(const char *fname);
 
     // finish uploading parameters
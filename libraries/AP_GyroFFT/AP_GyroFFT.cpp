@@ -57,6 +57,9 @@ extern const AP_HAL::HAL& hal;
 #define FFT_HARMONIC_FIT_MULT       50.0f
 #define FFT_HARMONIC_FIT_TRACK_ROLL    4
 #define FFT_HARMONIC_FIT_TRACK_PITCH   5
+#define FFT_IMU_AXES                2       // only roll and pitch are analysed on the IMUs other than the primary
+#define FFT_SDFT_REACQUIRE_FRAMES   4       // FFT frames per axis while the sliding DFT is tracking, 1 in 4 are run
+#define FFT_SDFT_MAX_DELAY_SAMPLES  8       // maximum samples between sliding DFT updates
 
 // table of user settable parameters
 const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
@@ -169,8 +172,8 @@ const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
 
     // @Param: OPTIONS
     // @DisplayName: FFT options
-    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference
-    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise
+    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference,4:Also track the noise peak on roll and pitch of the IMUs other than the primary and use it for their harmonic notches. This requires a sample mode of 0 and no frame averaging and at most doubles the CPU used by the FFT regardless of the number of IMUs,8:Track the center noise peak on every few samples with a sliding DFT, only running one in four FFT frames to re-acquire the peak while it is being tracked. This lowers the latency of the notch frequency and the CPU used by the FFT.
+    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise,2:Analyse all IMUs,3:Sliding DFT peak tracking
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("OPTIONS", 15, AP_GyroFFT, _options, 0),
@@ -232,9 +235,19 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
         _num_frames.set(constrain_int16(_num_frames, 2, AP_HAL::DSP::MAX_SLIDING_WINDOW_SIZE));
     }
 
+    // the IMUs other than the primary can only be analysed at the raw gyro rate and without frame averaging
+    // since the averaging is done in the shared FFT window state
+    const bool all_imus = (_options & uint32_t(Options::AllIMUs)) && _ins->get_gyro_count() > 1;
+    if (all_imus && (_sample_mode != 0 || _num_frames > 0)) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "AP_GyroFFT: all IMUs requires SAMPLE_MODE 0 and NUM_FRAMES 0");
+    }
+
     // check that we have enough memory for the window size requested
     // INS: XYZ_AXIS_COUNT * INS_MAX_INSTANCES * _window_size, DSP: 3 * _window_size, FFT: XYZ_AXIS_COUNT + 3 * _window_size
-    const uint32_t allocation_count = (XYZ_AXIS_COUNT * INS_MAX_INSTANCES + 3 + XYZ_AXIS_COUNT + 3 + _num_frames) * sizeof(float);
+    // IMUs: XYZ_AXIS_COUNT * INS_MAX_INSTANCES * _window_size, SDFT: XYZ_AXIS_COUNT * _window_size + 2 * _window_size
+    const bool sliding_dft = (_options & uint32_t(Options::SlidingDFTTracking)) != 0;
+    const uint32_t allocation_count = (XYZ_AXIS_COUNT * INS_MAX_INSTANCES + 3 + XYZ_AXIS_COUNT + 3 + _num_frames
+        + (all_imus ? XYZ_AXIS_COUNT * INS_MAX_INSTANCES : 0) + (sliding_dft ? XYZ_AXIS_COUNT + 2 : 0)) * sizeof(float);
     if (allocation_count * FFT_DEFAULT_WINDOW_SIZE > hal.util->available_memory() / 2) {
         gcs().send_text(MAV_SEVERITY_WARNING, "AP_GyroFFT: disabled, required %u bytes", (unsigned int)allocation_count * FFT_DEFAULT_WINDOW_SIZE);
         return;
@@ -265,6 +278,21 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
         return;
     }
 
+    // setup sliding DFT tracking, only the samples that arrived since the last update are read
+    if (sliding_dft) {
+        bool sdft_allocated = true;
+        for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            sdft_allocated = sdft_allocated && _sdft[axis].init(_window_size, _fft_sampling_rate_hz);
+        }
+        if (sdft_allocated) {
+            _sdft_samples = new float[FFT_SDFT_MAX_DELAY_SAMPLES];
+        }
+        if (_sdft_samples == nullptr) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "AP_GyroFFT: failed to allocate sliding DFT");
+        }
+        _sdft_gyro = _ins->get_primary_gyro();
+    }
+
     // make the gyro window match the window size plus a buffer to cope with the backend
     // getting too far ahead.
     if (!_ins->set_gyro_window_size(_window_size + _samples_per_frame)) {
@@ -353,6 +381,44 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
     // the number of cycles required to have a proper noise reference
     _noise_cycles = (_window_size / _samples_per_frame) * XYZ_AXIS_COUNT;
 
+    // setup analysis of the IMUs other than the primary
+    if (all_imus && _sample_mode == 0 && _num_frames == 0) {
+        const uint8_t num_gyros = _ins->get_gyro_count();
+        const uint8_t primary = _ins->get_primary_gyro();
+        uint8_t imu_mask = 0;
+        for (uint8_t i = 0; i < num_gyros; i++) {
+            // the primary is analysed by the main engine
+            if (i == primary) {
+                continue;
+            }
+            _imu_analysis[i]._ref_energy = new Vector3f[_window_size];
+            if (_imu_analysis[i]._ref_energy == nullptr) {
+                gcs().send_text(MAV_SEVERITY_WARNING, "Failed to allocate window for AP_GyroFFT");
+                for (uint8_t j = 0; j < i; j++) {
+                    delete[] _imu_analysis[j]._ref_energy;
+                    _imu_analysis[j]._ref_energy = nullptr;
+                }
+                return;
+            }
+            imu_mask |= 1U << i;
+        }
+        _imu_mask = imu_mask;
+        // one IMU axis is analysed for each frame of the primary, so each of the
+        // roll and pitch axes of the non-primary IMUs is analysed in turn
+        const uint8_t imu_axes = (num_gyros - 1) * FFT_IMU_AXES;
+        _imu_frame_time_ms = MAX(_frame_time_ms * imu_axes / XYZ_AXIS_COUNT, 1);
+        const float imu_output_rate = output_rate * XYZ_AXIS_COUNT / imu_axes;
+        for (uint8_t i = 0; i < num_gyros; i++) {
+            for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                _thread_imu_state[i]._center_freq_hz_filtered[axis] = _fft_min_hz;
+                _imu_analysis[i]._noise_calibration_cycles[axis] = (_window_size / _samples_per_frame) * 2;
+            }
+            _thread_imu_state[i]._noise_needs_calibration = (1U << FFT_IMU_AXES) - 1;
+            _imu_analysis[i]._center_freq_filter.set_cutoff_frequency(imu_output_rate, imu_output_rate * 0.48f * scale_factor);
+            _imu_analysis[i]._center_freq_energy_filter.set_cutoff_frequency(imu_output_rate, imu_output_rate * 0.25f * scale_factor);
+        }
+    }
+
     // finally we are done
     _initialized = true;
     update_parameters(true);
@@ -402,6 +468,9 @@ void AP_GyroFFT::update()
 
     _config._analysis_enabled = _analysis_enabled;
     _global_state = _thread_state;
+    if (analysing_all_imus()) {
+        memcpy(_global_imu_state, _thread_imu_state, sizeof(_global_imu_state));
+    }
 
     // calculate health based on being 5 frames behind, SITL needs longer
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
@@ -438,29 +507,54 @@ uint16_t AP_GyroFFT::run_cycle()
         return 0;
     }
 
+    // take a copy of the config inside the semaphore
+    EngineConfig config = _config;
+
     // do we have enough samples for another pass?
     if (!start_analysis()) {
         uint16_t new_sample_count =  get_available_samples(_update_axis);
         _sem.give();
+        // keep tracking the center peaks while waiting for a frame
+        if (using_sliding_dft()) {
+            update_sliding_dft(config);
+        }
         return new_sample_count;
     }
 
-    // take a copy of the config inside the semaphore
-    EngineConfig config = _config;
-
     _sem.give();
 
     uint32_t now = AP_HAL::micros();
 
     // get the appropriate gyro buffer
-    FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(_update_axis) : _downsampled_gyro_data[_update_axis]);
+    FloatBuffer& gyro_buffer = get_gyro_window(_update_axis);
+
+    if (using_sliding_dft()) {
+        update_sliding_dft(config);
+        // while the center peak is being tracked only run enough frames to re-acquire it
+        if (_sdft[_update_axis].is_locked() && ++_sdft_skipped_frames[_update_axis] < FFT_SDFT_REACQUIRE_FRAMES) {
+            gyro_buffer.advance(_samples_per_frame);
+            sliding_dft_advance(_update_axis, _samples_per_frame);
+            _thread_state._health_ms[_update_axis] = AP_HAL::millis();
+            if (analysing_all_imus()) {
+                run_imu_cycle(config);
+            }
+            _update_axis = (_update_axis + 1) % XYZ_AXIS_COUNT;
+            _thread_state._analysis_started = false;
+            return get_available_samples(_update_axis);
+        }
+        _sdft_skipped_frames[_update_axis] = 0;
+    }
+
     // if we have many more samples than the window size then we are struggling to 
     // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
     if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
-        gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
+        const uint16_t dropped = gyro_buffer.available() - _state->_window_size;
+        gyro_buffer.advance(dropped);
+        sliding_dft_advance(_update_axis, dropped);
     }
     // let's go!
     hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame);
+    sliding_dft_advance(_update_axis, _samples_per_frame);
 
     // calculate FFT and update filters outside the semaphore
     uint16_t bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
@@ -469,6 +563,16 @@ uint16_t AP_GyroFFT::run_cycle()
     update_ref_energy(bin_max);
     calculate_noise(false, config);
 
+    // re-acquire the center peak for the sliding DFT
+    if (using_sliding_dft()) {
+        if (!_thread_state._noise_needs_calibration && _thread_state._health[_update_axis] > 0
+            && _missed_cycles[_update_axis][FrequencyPeak::CENTER] == 0) {
+            _sdft[_update_axis].start(_thread_state._center_freq_bin[_update_axis]);
+        } else {
+            _sdft[_update_axis].stop();
+        }
+    }
+
     // record how we are doing
     _thread_state._last_output_us[_update_axis] = AP_HAL::micros();
     _output_cycle_micros = _thread_state._last_output_us[_update_axis] - now;
@@ -494,6 +598,11 @@ uint16_t AP_GyroFFT::run_cycle()
         _state->_freq_bins[_state->_peak_data[2]._bin]);
 #endif
 
+    // analyse one of the other IMUs while the primary gathers more samples
+    if (analysing_all_imus()) {
+        run_imu_cycle(config);
+    }
+
     // move onto the next axis
     _update_axis = (_update_axis + 1) % XYZ_AXIS_COUNT;
 
@@ -506,6 +615,139 @@ uint16_t AP_GyroFFT::run_cycle()
     return get_available_samples(_update_axis);
 }
 
+// analyse one axis of one of the IMUs other than the primary, cycling through the roll
+// and pitch axes of each IMU in turn. This is called once for every frame of the primary
+// so the CPU used is at most double that of the primary alone regardless of the number
+// of IMUs. The most recent window of samples is always used, maximising the overlap
+// between frames so that the output is as fresh as possible
+// called from FFT thread
+void AP_GyroFFT::run_imu_cycle(const EngineConfig& config)
+{
+    const uint8_t primary = _ins->get_primary_gyro();
+
+    // keep the windows trimmed to the most recent samples so that they never fill up
+    for (uint8_t i = 0; i < INS_MAX_INSTANCES; i++) {
+        if (!(_imu_mask & (1U << i)) || i == primary) {
+            continue;
+        }
+        for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            FloatBuffer& gyro_buffer = _ins->get_raw_gyro_window(i, axis);
+            if (gyro_buffer.available() > _state->_window_size) {
+                gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
+            }
+        }
+    }
+
+    // move onto the next axis of the next IMU that is not the primary
+    for (uint8_t i = 0; i < INS_MAX_INSTANCES * FFT_IMU_AXES; i++) {
+        if (++_update_imu_axis == FFT_IMU_AXES) {
+            _update_imu_axis = 0;
+            _update_imu = (_update_imu + 1) % INS_MAX_INSTANCES;
+        }
+        if ((_imu_mask & (1U << _update_imu)) && _update_imu != primary) {
+            break;
+        }
+    }
+
+    const uint8_t imu = _update_imu;
+    const uint8_t axis = _update_imu_axis;
+    FloatBuffer& gyro_buffer = _ins->get_raw_gyro_window(imu, axis);
+    if (imu == primary || gyro_buffer.available() < _state->_window_size) {
+        return;
+    }
+
+    hal.dsp->fft_start(_state, gyro_buffer, 0);
+    hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+
+    IMUAnalysis& analysis = _imu_analysis[imu];
+    IMUEngineState& imu_state = _thread_imu_state[imu];
+
+    // determine a noise reference for this IMU once the primary has settled
+    if (imu_state._noise_needs_calibration & (1U << axis)) {
+        if (_noise_cycles > 0) {
+            return;
+        }
+        for (uint16_t i = 1; i < _state->_bin_count; i++) {
+            analysis._ref_energy[i][axis] += _state->get_freq_bin(i);
+        }
+        if (--analysis._noise_calibration_cycles[axis] == 0) {
+            const float cycles = (static_cast<float>(_window_size) / static_cast<float>(_samples_per_frame)) * 2;
+            for (uint16_t i = 1; i < _state->_bin_count; i++) {
+                analysis._ref_energy[i][axis] = (analysis._ref_energy[i][axis] / cycles) * sqrtf(cycles);
+            }
+            imu_state._noise_needs_calibration &= ~(1U << axis);
+        }
+        return;
+    }
+
+    const AP_HAL::DSP::FrequencyPeakData& peak_data = _state->_peak_data[FrequencyPeak::CENTER];
+    const uint16_t bin = peak_data._bin;
+    const float max_energy = MAX(1.0f, _state->get_freq_bin(bin));
+    const float ref_energy = MAX(1.0f, analysis._ref_energy[bin][axis]);
+    const float snr = 10.f * (log10f(max_energy) - log10f(ref_energy));
+
+    if (isfinite(_state->get_freq_bin(bin)) && snr > config._snr_threshold_db) {
+        imu_state._center_freq_energy_filtered[axis] = analysis._center_freq_energy_filter.apply(axis, _state->get_freq_bin(bin) * peak_data._noise_width_hz * 0.8333f);
+        imu_state._center_freq_hz_filtered[axis] = analysis._center_freq_filter.apply(axis,
+            constrain_float(peak_data._freq_hz, (float)config._fft_min_hz, (float)config._fft_max_hz));
+        imu_state._health_ms[axis] = AP_HAL::millis();
+        analysis._missed_cycles[axis] = 0;
+    } else if (analysis._missed_cycles[axis] < FFT_MAX_MISSED_UPDATES) {
+        // carry on using the previous readings
+        analysis._missed_cycles[axis]++;
+    } else {
+        imu_state._health_ms[axis] = 0;
+    }
+}
+
+// whether any of the IMUs other than the primary still require noise calibration
+bool AP_GyroFFT::imus_need_calibration(const IMUEngineState* imu_state) const
+{
+    const uint8_t primary = _ins->get_primary_gyro();
+    for (uint8_t i = 0; i < INS_MAX_INSTANCES; i++) {
+        if ((_imu_mask & (1U << i)) && i != primary && imu_state[i]._noise_needs_calibration) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// feed the samples that have arrived since the last update to the sliding DFTs and publish
+// the tracked center peak on each axis, giving a new estimate every few samples rather than
+// once per frame
+// called from FFT thread
+void AP_GyroFFT::update_sliding_dft(const EngineConfig& config)
+{
+    // the raw gyro windows belong to the primary gyro, start again if it has changed
+    if (_sample_mode == 0 && _ins->get_primary_gyro() != _sdft_gyro) {
+        _sdft_gyro = _ins->get_primary_gyro();
+        for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            _sdft[axis].stop();
+            _sdft_seen[axis] = get_available_samples(axis);
+        }
+        return;
+    }
+
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        FloatBuffer& gyro_buffer = get_gyro_window(axis);
+        // new samples are at the end of the window, read just those
+        uint16_t count;
+        while ((count = gyro_buffer.peek(_sdft_seen[axis], _sdft_samples, FFT_SDFT_MAX_DELAY_SAMPLES)) > 0) {
+            for (uint16_t i = 0; i < count; i++) {
+                _sdft[axis].update(_sdft_samples[i]);
+            }
+            _sdft_seen[axis] += count;
+        }
+
+        if (_sdft[axis].track()) {
+            const float freq_hz = constrain_float(_sdft[axis].get_peak_freq_hz(), (float)config._fft_min_hz, (float)config._fft_max_hz);
+            _thread_state._center_freq_hz[axis] = freq_hz;
+            _thread_state._center_freq_hz_filtered[FrequencyPeak::CENTER][axis] = freq_hz;
+            _thread_state._center_freq_bin[axis] = _sdft[axis].get_peak_bin();
+        }
+    }
+}
+
 // whether analysis can be run again or not
 // called from FFT thread with the semaphore held
 bool AP_GyroFFT::start_analysis() {
@@ -513,7 +755,7 @@ bool AP_GyroFFT::start_analysis() {
         return false;
     }
     // don't run any more gyro cycles once noise is calibrated and the self-test is running
-    if (!_thread_state._noise_needs_calibration && !_calibrated) {
+    if (!_thread_state._noise_needs_calibration && !imus_need_calibration(_thread_imu_state) && !_calibrated) {
         return false;
     }
 
@@ -555,7 +797,9 @@ void AP_GyroFFT::update_thread(void)
         // this is to stop us burning CPU while waiting for samples, the reduction by _samples_per_frame is a heuristic to prevent waiting too long
         // and missing frames (easy to see in SITL because the noise will keep calibrating)
         // we always delay by at least 1us to give logging a chance to run at the same priority
-        uint32_t delay = constrain_int32((int16_t)_state->_window_size - (int16_t)remaining_samples, 0, _samples_per_frame)
+        // the sliding DFT needs to see new samples more often than once per frame
+        const uint16_t max_delay_samples = using_sliding_dft() ? FFT_SDFT_MAX_DELAY_SAMPLES : _samples_per_frame;
+        uint32_t delay = constrain_int32((int16_t)_state->_window_size - (int16_t)remaining_samples, 0, max_delay_samples)
             * 1e6 / _fft_sampling_rate_hz;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         // in SITL the gyros do not run in a different thread
@@ -594,6 +838,12 @@ bool AP_GyroFFT::pre_arm_check(char *failure_msg, const uint8_t failure_msg_len)
         return true;
     }
 
+    // the IMU frequencies are only used by notches that run on all of the IMUs
+    if (analysing_all_imus() && !_ins->has_fft_notch_on_all_imus()) {
+        hal.util->snprintf(failure_msg, failure_msg_len, "FFT all IMUs needs notch EnableOnAllIMUs");
+        return false;
+    }
+
     // already calibrated
     if (_calibrated) {
         return true;
@@ -606,7 +856,7 @@ bool AP_GyroFFT::pre_arm_check(char *failure_msg, const uint8_t failure_msg_len)
     }
 
     // still calibrating noise so not ready
-    if (_global_state._noise_needs_calibration) {
+    if (_global_state._noise_needs_calibration || imus_need_calibration(_global_imu_state)) {
         hal.util->snprintf(failure_msg, failure_msg_len, "FFT calibrating noise");
         return false;
     }
@@ -909,6 +1159,38 @@ uint8_t AP_GyroFFT::get_weighted_noise_center_frequencies_hz(uint8_t num_freqs,
     return tracked_peaks;
 }
 
+// return the energy-weighted roll and pitch peak frequency of an IMU other than the primary
+// called from main thread
+float AP_GyroFFT::get_imu_weighted_noise_center_freq_hz(uint8_t instance) const
+{
+    if (!analysis_enabled() || instance >= INS_MAX_INSTANCES
+        || !(_imu_mask & (1U << instance)) || instance == _ins->get_primary_gyro()) {
+        return 0.0f;
+    }
+
+    const IMUEngineState& imu_state = _global_imu_state[instance];
+    // calculate health based on being 5 frames behind, SITL needs longer
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    const uint32_t output_delay = _imu_frame_time_ms * FFT_MAX_MISSED_UPDATES * 2;
+#else
+    const uint32_t output_delay = _imu_frame_time_ms * FFT_MAX_MISSED_UPDATES;
+#endif
+    const uint32_t now = AP_HAL::millis();
+    const bool roll_healthy = imu_state._health_ms.x != 0 && now - imu_state._health_ms.x <= output_delay;
+    const bool pitch_healthy = imu_state._health_ms.y != 0 && now - imu_state._health_ms.y <= output_delay;
+
+    if (roll_healthy && pitch_healthy) {
+        return calculate_weighted_freq_hz(imu_state._center_freq_energy_filtered, imu_state._center_freq_hz_filtered);
+    }
+    if (roll_healthy) {
+        return imu_state._center_freq_hz_filtered.x;
+    }
+    if (pitch_healthy) {
+        return imu_state._center_freq_hz_filtered.y;
+    }
+    return 0.0f;
+}
+
 // return noise energy at the requested frequency
 float AP_GyroFFT::has_noise_at_frequency_hz(float freq) const
 {
@@ -996,6 +1278,12 @@ void AP_GyroFFT::write_log_messages()
         log_noise_peak(2, FrequencyPeak::UPPER_SHOULDER);
     }
 
+    for (uint8_t i = 0; i < INS_MAX_INSTANCES; i++) {
+        if ((_imu_mask & (1U << i)) && i != _ins->get_primary_gyro()) {
+            log_imu_noise_peak(i);
+        }
+    }
+
 #if DEBUG_FFT
     const uint32_t now = AP_HAL::millis();
     // output at 1hz
@@ -1048,6 +1336,30 @@ void AP_GyroFFT::log_noise_peak(uint8_t id, FrequencyPeak peak) const
         get_center_freq_energy(peak).z);
 }
 
+// @LoggerMessage: FTN4
+// @Description: FFT Noise Frequency Peak of the IMUs other than the primary
+// @Field: TimeUS: microseconds since system startup
+// @Field: I: IMU instance
+// @Field: PkAvg: peak noise frequency as an energy-weighted average of roll and pitch peak frequencies, zero if there is no signal
+// @Field: PkX: noise frequency of the peak on roll
+// @Field: PkY: noise frequency of the peak on pitch
+// @Field: EnX: power spectral density bin energy of the peak on roll
+// @Field: EnY: power spectral density bin energy of the peak on pitch
+
+// write a single log message
+void AP_GyroFFT::log_imu_noise_peak(uint8_t instance) const
+{
+    const IMUEngineState& imu_state = _global_imu_state[instance];
+    AP::logger().WriteStreaming("FTN4", "TimeUS,I,PkAvg,PkX,PkY,EnX,EnY", "s#zzz--", "F------", "QBfffff",
+        AP_HAL::micros64(),
+        instance,
+        get_imu_weighted_noise_center_freq_hz(instance),
+        imu_state._center_freq_hz_filtered.x,
+        imu_state._center_freq_hz_filtered.y,
+        imu_state._center_freq_energy_filtered.x,
+        imu_state._center_freq_energy_filtered.y);
+}
+
 // return an average noise bandwidth weighted by bin energy
 // called from main thread
 float AP_GyroFFT::get_weighted_noise_center_bandwidth_hz() const
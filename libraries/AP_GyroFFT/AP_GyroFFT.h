@@ -27,6 +27,7 @@
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <Filter/LowPassFilter.h>
 #include <Filter/FilterWithBuffer.h>
+#include "SlidingDFT.h"
 
 #define DEBUG_FFT   0
 
@@ -40,7 +41,9 @@ public:
 
     enum class Options : uint32_t {
         FFTPostFilter = 1 << 0,
-        ESCNoiseCheck = 1 << 1
+        ESCNoiseCheck = 1 << 1,
+        AllIMUs = 1 << 2,
+        SlidingDFTTracking = 1 << 3,
     };
 
     AP_GyroFFT();
@@ -113,6 +116,14 @@ public:
     bool check_esc_noise() const { return (_options & uint32_t(Options::ESCNoiseCheck)) != 0; }
     // look for a frequency in the detected noise
     float has_noise_at_frequency_hz(float freq) const;
+    // whether the center peak is tracked with a sliding DFT between FFT frames
+    bool using_sliding_dft() const { return _sdft_samples != nullptr; }
+    // whether the IMUs other than the primary are also being analysed
+    bool analysing_all_imus() const { return _imu_mask != 0; }
+    // detected peak frequency of an IMU other than the primary, filtered
+    const Vector3f& get_imu_noise_center_freq_hz(uint8_t instance) const { return _global_imu_state[instance]._center_freq_hz_filtered; }
+    // energy-weighted roll and pitch peak frequency of an IMU other than the primary, zero if there is no signal
+    float get_imu_weighted_noise_center_freq_hz(uint8_t instance) const;
     static float calculate_notch_frequency(float* freqs, uint16_t numpeaks, float harmonic_fit, uint8_t& harmonics);
     static bool is_harmonic_of(float harmonic, float fundamental, uint8_t mult, float _fit) {
         const float fit = 100.0f * fabsf(harmonic - fundamental * mult) / harmonic;
@@ -192,6 +203,9 @@ private:
     }
     // write single log mesages
     void log_noise_peak(uint8_t id, FrequencyPeak peak) const;
+    void log_imu_noise_peak(uint8_t instance) const;
+    // analyse one axis of one of the IMUs other than the primary
+    void run_imu_cycle(const EngineConfig& config);
     // calculate the peak noise frequency
     void calculate_noise(bool calibrating, const EngineConfig& config);
     // calculate noise peaks based on energy and history
@@ -220,9 +234,19 @@ private:
     bool analysis_enabled() const { return _initialized && _analysis_enabled && _thread_created; };
     // whether analysis can be run again or not
     bool start_analysis();
+    // return the gyro window being analysed
+    FloatBuffer& get_gyro_window(uint8_t axis) {
+        return _sample_mode == 0 ? _ins->get_raw_gyro_window(axis) : _downsampled_gyro_data[axis];
+    }
     // return samples available in the gyro window
     uint16_t get_available_samples(uint8_t axis) {
-        return _sample_mode == 0 ?_ins->get_raw_gyro_window(axis).available() : _downsampled_gyro_data[axis].available();
+        return get_gyro_window(axis).available();
+    }
+    // feed new gyro samples to the sliding DFTs and publish the tracked center peaks
+    void update_sliding_dft(const EngineConfig& config);
+    // samples consumed from the front of a gyro window no longer count as seen by the sliding DFT
+    void sliding_dft_advance(uint8_t axis, uint16_t count) {
+        _sdft_seen[axis] -= MIN(_sdft_seen[axis], count);
     }
     void update_parameters(bool force);
     // semaphore for access to shared FFT data
@@ -268,6 +292,60 @@ private:
     // Shared FFT engine state accessible by the main thread
     EngineState _global_state;
 
+    // peak tracking of the IMUs other than the primary. These only track the highest
+    // energy peak on roll and pitch and always analyse the most recent window of
+    // samples, sharing the FFT window state and thread with the primary IMU
+    struct IMUEngineState {
+        // filtered version of the peak frequency
+        Vector3f _center_freq_hz_filtered;
+        // filtered energy of the detected peak frequency
+        Vector3f _center_freq_energy_filtered;
+        // when we last detected a signal
+        Vector3ul _health_ms;
+        // axes that still require noise calibration
+        uint8_t _noise_needs_calibration;
+    };
+
+    // IMU state local to the FFT thread
+    IMUEngineState _thread_imu_state[INS_MAX_INSTANCES];
+    // IMU state accessible by the main thread
+    IMUEngineState _global_imu_state[INS_MAX_INSTANCES];
+    // whether any of the IMUs other than the primary still require noise calibration
+    bool imus_need_calibration(const IMUEngineState* imu_state) const;
+
+    // IMU analysis data only used by the FFT thread
+    struct IMUAnalysis {
+        // noise base of the gyro
+        Vector3f* _ref_energy;
+        // number of cycles over which to generate noise ensemble averages
+        uint16_t _noise_calibration_cycles[XYZ_AXIS_COUNT];
+        // number of cycles without a detected signal
+        uint8_t _missed_cycles[XYZ_AXIS_COUNT];
+        // smoothing filters on the output
+        MedianLowPassFilter3dFloat _center_freq_filter;
+        MedianLowPassFilter3dFloat _center_freq_energy_filter;
+    } _imu_analysis[INS_MAX_INSTANCES];
+
+    // sliding DFT tracking of the center peak on each axis between FFT frames
+    SlidingDFT _sdft[XYZ_AXIS_COUNT];
+    // number of samples at the front of each gyro window already given to the sliding DFT
+    uint16_t _sdft_seen[XYZ_AXIS_COUNT];
+    // FFT frames skipped on each axis while the sliding DFT is tracking the center peak
+    uint8_t _sdft_skipped_frames[XYZ_AXIS_COUNT];
+    // gyro whose windows the sliding DFT is following
+    uint8_t _sdft_gyro;
+    // scratch space for reading new samples from the gyro windows
+    float* _sdft_samples;
+
+    // mask of the IMUs to analyse, all but the primary at startup. Should the primary
+    // change, it is skipped and the old primary's notch uses the common frequency
+    uint8_t _imu_mask;
+    // number of ms between analyses of each axis of each IMU
+    uint16_t _imu_frame_time_ms;
+    // IMU and axis to analyse in the next IMU cycle
+    uint8_t _update_imu;
+    uint8_t _update_imu_axis;
+
     // number of samples needed before a new frame can be processed
     uint16_t _samples_per_frame;
     // number of ms that a frame should take to process to sustain output rate
@@ -0,0 +1,182 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SlidingDFT.h"
+
+#include <AP_Math/AP_Math.h>
+
+// the peak is lost if its energy falls 10dB below the energy at acquisition
+#define SDFT_LOST_ENERGY_RATIO 0.1f
+
+SlidingDFT::~SlidingDFT()
+{
+    delete[] _samples;
+}
+
+// allocate the sample history, returns false on failure
+bool SlidingDFT::init(uint16_t window_size, float sample_rate_hz)
+{
+    delete[] _samples;
+    _samples = new float[window_size];
+    if (_samples == nullptr) {
+        return false;
+    }
+    memset(_samples, 0, sizeof(float) * window_size);
+    _window_size = window_size;
+    _bin_resolution = sample_rate_hz / window_size;
+    _oldest = 0;
+    _num_samples = 0;
+    _locked = false;
+    return true;
+}
+
+// add a sample, removing the oldest from the window
+void SlidingDFT::update(float sample)
+{
+    const float delta = sample - _samples[_oldest];
+    _samples[_oldest] = sample;
+    if (++_oldest == _window_size) {
+        _oldest = 0;
+    }
+    if (_num_samples < _window_size) {
+        _num_samples++;
+    }
+
+    if (!_locked) {
+        return;
+    }
+
+    // X[k] = (X[k] - x[n - N] + x[n]) * e^(j2pik/N)
+    for (uint8_t i = 0; i < NUM_BINS; i++) {
+        const float re = _re[i] + delta;
+        const float im = _im[i];
+        _re[i] = re * _rot_re[i] - im * _rot_im[i];
+        _im[i] = re * _rot_im[i] + im * _rot_re[i];
+    }
+}
+
+// calculate the band centered on bin directly from the window of samples
+void SlidingDFT::calculate_band(uint16_t bin)
+{
+    _start_bin = bin - HALF_BAND;
+
+    for (uint8_t i = 0; i < NUM_BINS; i++) {
+        const float w = M_2PI * (_start_bin + i) / _window_size;
+        _rot_re[i] = cosf(w);
+        _rot_im[i] = sinf(w);
+
+        // sum the window against e^(-jwm), rotating the phasor by one sample each time
+        float p_re = 1.0f;
+        float p_im = 0.0f;
+        float re = 0.0f;
+        float im = 0.0f;
+        uint16_t idx = _oldest;
+        for (uint16_t m = 0; m < _window_size; m++) {
+            re += _samples[idx] * p_re;
+            im += _samples[idx] * p_im;
+            const float next_re = p_re * _rot_re[i] + p_im * _rot_im[i];
+            p_im = p_im * _rot_re[i] - p_re * _rot_im[i];
+            p_re = next_re;
+            if (++idx == _window_size) {
+                idx = 0;
+            }
+        }
+        _re[i] = re;
+        _im[i] = im;
+    }
+}
+
+// squared magnitude of the Hann windowed band at index i
+float SlidingDFT::windowed_energy(uint8_t i) const
+{
+    const float re = 0.5f * _re[i] - 0.25f * (_re[i - 1] + _re[i + 1]);
+    const float im = 0.5f * _im[i] - 0.25f * (_im[i - 1] + _im[i + 1]);
+    return re * re + im * im;
+}
+
+// start tracking a peak at bin, calculating the band from the window of samples
+bool SlidingDFT::start(uint16_t bin)
+{
+    if (_samples == nullptr || _num_samples < _window_size) {
+        return false;
+    }
+
+    calculate_band(constrain_int16(bin, HALF_BAND, _window_size / 2 - HALF_BAND));
+
+    _lock_energy = 0.0f;
+    for (uint8_t i = 1; i < NUM_BINS - 1; i++) {
+        _lock_energy = MAX(_lock_energy, windowed_energy(i));
+    }
+    _locked = true;
+
+    return track();
+}
+
+// find the peak in the band, following it if it has moved. Returns false if the peak has been lost
+bool SlidingDFT::track()
+{
+    if (!_locked) {
+        return false;
+    }
+
+    uint8_t peak = 0;
+    float peak_energy = 0.0f;
+    // re-center at most twice, a peak moving more than a bin between calls is not being tracked
+    for (uint8_t attempt = 0; attempt < 3; attempt++) {
+        peak = 1;
+        peak_energy = windowed_energy(1);
+        for (uint8_t i = 2; i < NUM_BINS - 1; i++) {
+            const float energy = windowed_energy(i);
+            if (energy > peak_energy) {
+                peak = i;
+                peak_energy = energy;
+            }
+        }
+        // interpolation needs the windowed bins either side of the peak
+        if (peak > 1 && peak < NUM_BINS - 2) {
+            break;
+        }
+        const int16_t bin = _start_bin + peak;
+        if (attempt == 2 || bin < HALF_BAND || bin > _window_size / 2 - HALF_BAND) {
+            _locked = false;
+            return false;
+        }
+        calculate_band(bin);
+    }
+
+    if (!is_positive(peak_energy) || peak_energy < _lock_energy * SDFT_LOST_ENERGY_RATIO) {
+        _locked = false;
+        return false;
+    }
+
+    // interpolate using the ratio of the peak to the larger neighbour, which for
+    // a Hann window is (1 + d) / (2 - d) for a tone d bins from the peak bin
+    const float y1 = sqrtf(windowed_energy(peak - 1));
+    const float y2 = sqrtf(peak_energy);
+    const float y3 = sqrtf(windowed_energy(peak + 1));
+    float d;
+    if (y3 > y1) {
+        const float a = y3 / y2;
+        d = (2.0f * a - 1.0f) / (1.0f + a);
+    } else {
+        const float a = y1 / y2;
+        d = (1.0f - 2.0f * a) / (1.0f + a);
+    }
+
+    _peak_bin = _start_bin + peak;
+    _peak_freq_hz = (_peak_bin + constrain_float(d, -0.5f, 0.5f)) * _bin_resolution;
+
+    return true;
+}
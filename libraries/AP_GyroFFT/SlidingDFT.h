@@ -0,0 +1,88 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+
+/*
+  sliding DFT of a narrow band of bins around a spectral peak.
+
+  Each new sample updates the band in a handful of complex multiplies,
+  rather than the full FFT of the window, so that a peak found by the
+  FFT can be tracked on every sample. A Hann window is applied in the
+  frequency domain and the band follows the peak as it moves. The peak
+  is lost when its energy falls too far below the energy at which it
+  was acquired.
+ */
+class SlidingDFT {
+public:
+    // raw bins either side of the center bin, the Hann window uses one of
+    // these on each side and interpolation another, so the peak can move
+    // one bin before the band is re-centered
+    static const uint8_t HALF_BAND = 3;
+    static const uint8_t NUM_BINS = HALF_BAND * 2 + 1;
+
+    SlidingDFT() {}
+    ~SlidingDFT();
+
+    CLASS_NO_COPY(SlidingDFT);
+
+    // allocate the sample history, returns false on failure
+    bool init(uint16_t window_size, float sample_rate_hz);
+    // add a sample, removing the oldest from the window
+    void update(float sample);
+    // start tracking a peak at bin, calculating the band from the window of samples.
+    // Returns false if the window is not yet full
+    bool start(uint16_t bin);
+    // stop tracking
+    void stop() { _locked = false; }
+    // find the peak in the band, following it if it has moved. Returns false if the peak has been lost
+    bool track();
+
+    bool is_locked() const { return _locked; }
+    // interpolated frequency of the peak, valid after track()
+    float get_peak_freq_hz() const { return _peak_freq_hz; }
+    // bin containing the peak, valid after track()
+    uint16_t get_peak_bin() const { return _peak_bin; }
+
+private:
+    // calculate the band centered on bin directly from the window of samples
+    void calculate_band(uint16_t bin);
+    // squared magnitude of the Hann windowed band at index i
+    float windowed_energy(uint8_t i) const;
+
+    float* _samples = nullptr;
+    uint16_t _window_size;
+    float _bin_resolution;
+    // index of the oldest sample in the window
+    uint16_t _oldest;
+    // number of samples in the window, saturating at the window size
+    uint16_t _num_samples = 0;
+
+    // first bin of the band
+    uint16_t _start_bin;
+    // complex DFT of the band of bins
+    float _re[NUM_BINS];
+    float _im[NUM_BINS];
+    // rotation applied to each bin for every sample
+    float _rot_re[NUM_BINS];
+    float _rot_im[NUM_BINS];
+
+    // energy of the peak when it was acquired
+    float _lock_energy;
+    float _peak_freq_hz;
+    uint16_t _peak_bin;
+    bool _locked = false;
+};
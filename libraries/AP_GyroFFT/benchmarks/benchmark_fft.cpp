@@ -0,0 +1,121 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/utility/RealFFT.h>
+#include <AP_Math/AP_Math.h>
+
+#include <complex>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+typedef std::complex<float> complexf;
+
+// a Hann windowed frame of gyro samples with motor noise at 2kHz
+static void gyro_window(float* samples, uint16_t window_size)
+{
+    for (uint16_t n = 0; n < window_size; n++) {
+        const float t = n / 2000.0f;
+        const float hann = 0.5f - 0.5f * cosf(M_2PI * n / (window_size - 1));
+        samples[n] = hann * (sinf(M_2PI * 182 * t) + 0.5f * sinf(M_2PI * 364 * t) + 0.1f);
+    }
+}
+
+/*
+  the scalar radix-2 FFT and unpacking done by HALSITL::DSP::step_fft()
+ */
+static void reference_fft(const float* samples, complexf* buf, float* cplx, float* power, uint16_t fftlen)
+{
+    for (uint16_t i = 0; i < fftlen; i++) {
+        buf[i] = complexf(samples[i], 0);
+    }
+
+    uint16_t m = 0;
+    while ((1U << m) < fftlen) {
+        m++;
+    }
+    for (uint16_t k = 0; k < fftlen; k++) {
+        uint16_t ki = k, kr = 0;
+        for (uint16_t i=1; i<=m; i++) {
+            kr <<= 1;
+            if (ki % 2 == 1) {
+                kr++;
+            }
+            ki >>= 1;
+        }
+        if (kr > k) {
+            complexf t = buf[kr];
+            buf[kr] = buf[k];
+            buf[k] = t;
+        }
+    }
+
+    uint16_t istep = 2;
+    while (istep <= fftlen) {
+        uint16_t is2 = istep / 2;
+        uint16_t astep = fftlen / istep;
+        for (uint16_t km = 0; km < is2; km++) {
+            uint16_t a  = km * astep;
+            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
+            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) {
+                uint16_t i = km + ki;
+                uint16_t j = is2 + i;
+                complexf t = w * buf[j];
+                complexf q = buf[i];
+                buf[j] = q - t;
+                buf[i] = q + t;
+            }
+        }
+        istep <<= 1;
+    }
+
+    for (uint16_t i = 0; i < fftlen / 2; i++) {
+        power[i] = std::norm(buf[i]);
+    }
+    for (uint16_t i = 0, j = 0; i <= fftlen / 2; i++, j += 2) {
+        cplx[j] = buf[i].real();
+        cplx[j+1] = buf[i].imag();
+    }
+}
+
+static void BM_ReferenceFFT(benchmark::State& state)
+{
+    const uint16_t window_size = state.range(0);
+    float samples[512];
+    float cplx[512 + 2];
+    float power[512];
+    complexf buf[512];
+    gyro_window(samples, window_size);
+
+    while (state.KeepRunning()) {
+        reference_fft(samples, buf, cplx, power, window_size);
+        gbenchmark_escape(power);
+    }
+}
+
+static void BM_RealFFT(benchmark::State& state)
+{
+    const uint16_t window_size = state.range(0);
+    float samples[512];
+    float cplx[512 + 2];
+    float power[512];
+    gyro_window(samples, window_size);
+
+    RealFFT fft;
+    if (!fft.init(window_size)) {
+        state.SkipWithError("RealFFT::init() failed");
+        return;
+    }
+    if (!RealFFT::simd_enabled()) {
+        state.SetLabel("scalar");
+    }
+
+    while (state.KeepRunning()) {
+        fft.transform(samples, cplx, power);
+        gbenchmark_escape(power);
+    }
+}
+
+// the window sizes allowed by FFT_WINDOW_SIZE on Linux and SITL
+BENCHMARK(BM_ReferenceFFT)->RangeMultiplier(2)->Range(32, 512);
+BENCHMARK(BM_RealFFT)->RangeMultiplier(2)->Range(32, 512);
+
+BENCHMARK_MAIN();
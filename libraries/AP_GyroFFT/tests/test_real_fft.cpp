@@ -0,0 +1,169 @@
+#include <AP_gtest.h>
+#include <AP_HAL/HAL.h>
+#include <AP_HAL/utility/RealFFT.h>
+#include <AP_Math/AP_Math.h>
+
+#include <complex>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+typedef std::complex<float> complexf;
+
+/*
+  the scalar radix-2 FFT used by HALSITL::DSP, that RealFFT must agree with
+ */
+static void reference_fft(complexf *samples, uint16_t fftlen)
+{
+    uint16_t m = 0;
+    while ((1U << m) < fftlen) {
+        m++;
+    }
+    for (uint16_t k = 0; k < fftlen; k++) {
+        uint16_t ki = k, kr = 0;
+        for (uint16_t i=1; i<=m; i++) {
+            kr <<= 1;
+            if (ki % 2 == 1) {
+                kr++;
+            }
+            ki >>= 1;
+        }
+        if (kr > k) {
+            complexf t = samples[kr];
+            samples[kr] = samples[k];
+            samples[k] = t;
+        }
+    }
+
+    uint16_t istep = 2;
+    while (istep <= fftlen) {
+        uint16_t is2 = istep / 2;
+        uint16_t astep = fftlen / istep;
+        for (uint16_t km = 0; km < is2; km++) {
+            uint16_t a  = km * astep;
+            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
+            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) {
+                uint16_t i = km + ki;
+                uint16_t j = is2 + i;
+                complexf t = w * samples[j];
+                complexf q = samples[i];
+                samples[j] = q - t;
+                samples[i] = q + t;
+            }
+        }
+        istep <<= 1;
+    }
+}
+
+// gyro-like test signal, a few motor noise peaks with harmonics on top of broadband noise
+static void make_samples(float* samples, uint16_t window_size, uint32_t seed)
+{
+    for (uint16_t n = 0; n < window_size; n++) {
+        const float t = n / 1000.0f;
+        seed = seed * 1664525U + 1013904223U;
+        const float noise = ((seed >> 8) / float(1U << 24)) - 0.5f;
+        samples[n] = 40.0f * sinf(M_2PI * 187.3f * t + 0.3f) + 12.0f * sinf(M_2PI * 374.6f * t)
+            + 3.0f * cosf(M_2PI * 61.0f * t) + 2.0f * noise + 0.7f;
+    }
+}
+
+/*
+  the spectrum must match the reference bin for bin. The order of operations differs so the
+  results are not bit identical, instead they must agree to within the rounding error of
+  the reference itself, measured against a DFT in double precision
+ */
+static void check_window(uint16_t window_size, uint32_t seed)
+{
+    RealFFT fft;
+    ASSERT_TRUE(fft.init(window_size));
+    ASSERT_EQ(fft.get_window_size(), window_size);
+
+    const uint16_t bins = window_size / 2;
+    float samples[512];
+    float cplx[512 + 2];
+    float power[512];
+    complexf ref[512];
+
+    make_samples(samples, window_size, seed);
+    for (uint16_t i = 0; i < window_size; i++) {
+        ref[i] = complexf(samples[i], 0);
+    }
+    reference_fft(ref, window_size);
+
+    // transform in place over the samples, as the DSP backend does
+    memcpy(power, samples, sizeof(float) * window_size);
+    fft.transform(power, cplx, power);
+
+    double ref_err = 0;
+    double fft_err = 0;
+    double max_mag = 0;
+    for (uint16_t k = 0; k <= bins; k++) {
+        std::complex<double> exact = 0;
+        for (uint16_t n = 0; n < window_size; n++) {
+            exact += double(samples[n]) * std::polar(1.0, 2.0 * M_PI * k * n / window_size);
+        }
+        const std::complex<double> actual(cplx[2 * k], cplx[2 * k + 1]);
+        const std::complex<double> expected(ref[k].real(), ref[k].imag());
+        ref_err = MAX(ref_err, std::abs(expected - exact));
+        fft_err = MAX(fft_err, std::abs(actual - exact));
+        max_mag = MAX(max_mag, std::abs(exact));
+
+        EXPECT_NEAR(cplx[2 * k], ref[k].real(), 1e-5 * max_mag + 1e-4) << "bin " << k << " of " << window_size;
+        EXPECT_NEAR(cplx[2 * k + 1], ref[k].imag(), 1e-5 * max_mag + 1e-4) << "bin " << k << " of " << window_size;
+        if (k < bins) {
+            EXPECT_NEAR(power[k], std::norm(ref[k]), 2e-5 * sq(max_mag) + 1e-4) << "bin " << k << " of " << window_size;
+        }
+    }
+    // DC and nyquist are real only
+    EXPECT_EQ(cplx[1], 0.0f);
+    EXPECT_EQ(cplx[2 * bins + 1], 0.0f);
+    // at least as accurate as the reference
+    EXPECT_LE(fft_err, MAX(ref_err, 1e-6 * max_mag));
+}
+
+TEST(RealFFTTest, MatchesReference)
+{
+    for (uint16_t window_size = 8; window_size <= 512; window_size *= 2) {
+        for (uint32_t seed = 1; seed <= 3; seed++) {
+            check_window(window_size, seed);
+        }
+    }
+}
+
+// a single tone lands in the right bin with the right phase
+TEST(RealFFTTest, Tone)
+{
+    const uint16_t window_size = 128;
+    RealFFT fft;
+    ASSERT_TRUE(fft.init(window_size));
+
+    float samples[window_size];
+    float cplx[window_size + 2];
+    float power[window_size / 2];
+    for (uint16_t n = 0; n < window_size; n++) {
+        samples[n] = cosf(M_2PI * 10 * n / window_size);
+    }
+    fft.transform(samples, cplx, power);
+
+    for (uint16_t k = 0; k < window_size / 2; k++) {
+        if (k == 10) {
+            EXPECT_NEAR(cplx[2 * k], window_size / 2, 1e-3);
+            EXPECT_NEAR(power[k], sq(window_size / 2), 1e-1);
+        } else {
+            EXPECT_NEAR(power[k], 0.0f, 1e-6);
+        }
+        EXPECT_NEAR(cplx[2 * k + 1], 0.0f, 1e-3);
+    }
+}
+
+TEST(RealFFTTest, InvalidSize)
+{
+    RealFFT fft;
+    EXPECT_FALSE(fft.init(4));
+    EXPECT_FALSE(fft.init(96));
+    EXPECT_TRUE(fft.init(32));
+    // re-initialising replaces the tables
+    EXPECT_TRUE(fft.init(512));
+    EXPECT_EQ(fft.get_window_size(), 512);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,90 @@
+#include <AP_gtest.h>
+#include <AP_HAL/HAL.h>
+#include <AP_GyroFFT/SlidingDFT.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t window_size = 64;
+static const float sample_rate_hz = 1000;
+
+// the tracked frequency of a steady tone matches the tone
+TEST(SlidingDFTTest, SteadyTone)
+{
+    SlidingDFT sdft;
+    ASSERT_TRUE(sdft.init(window_size, sample_rate_hz));
+
+    const float freq_hz = 133.0f;
+    uint32_t n = 0;
+    for (; n < window_size; n++) {
+        sdft.update(sinf(M_2PI * freq_hz * n / sample_rate_hz) + 0.1f);
+    }
+    // start one bin away from the peak, as the FFT may have seen it
+    ASSERT_TRUE(sdft.start(lrintf(freq_hz / (sample_rate_hz / window_size)) + 1));
+    EXPECT_NEAR(sdft.get_peak_freq_hz(), freq_hz, 0.5f);
+
+    // a few thousand samples to check that errors do not accumulate
+    for (; n < 5000; n++) {
+        sdft.update(sinf(M_2PI * freq_hz * n / sample_rate_hz) + 0.1f);
+        if (n % 16 == 0) {
+            ASSERT_TRUE(sdft.track());
+        }
+    }
+    EXPECT_NEAR(sdft.get_peak_freq_hz(), freq_hz, 0.5f);
+}
+
+// a tone that sweeps across several bins is followed
+TEST(SlidingDFTTest, Sweep)
+{
+    SlidingDFT sdft;
+    ASSERT_TRUE(sdft.init(window_size, sample_rate_hz));
+
+    float phase = 0;
+    float freq_hz = 80.0f;
+    uint32_t n = 0;
+    for (; n < window_size; n++) {
+        phase += M_2PI * freq_hz / sample_rate_hz;
+        sdft.update(sinf(phase));
+    }
+    ASSERT_TRUE(sdft.start(lrintf(freq_hz / (sample_rate_hz / window_size))));
+
+    // 80Hz to 200Hz over 2s, about 2 bins per 250ms
+    for (; n < 2000 + window_size; n++) {
+        freq_hz += 120.0f / 2000;
+        phase += M_2PI * freq_hz / sample_rate_hz;
+        sdft.update(sinf(phase));
+        if (n % 8 == 0) {
+            ASSERT_TRUE(sdft.track());
+        }
+    }
+    ASSERT_TRUE(sdft.track());
+    // the window lags the sweep by half its length
+    const float window_freq_hz = freq_hz - 120.0f / 2000 * window_size / 2;
+    EXPECT_NEAR(sdft.get_peak_freq_hz(), window_freq_hz, 1.0f);
+}
+
+// the peak is lost when the tone stops
+TEST(SlidingDFTTest, Lost)
+{
+    SlidingDFT sdft;
+    ASSERT_TRUE(sdft.init(window_size, sample_rate_hz));
+
+    const float freq_hz = 200.0f;
+    uint32_t n = 0;
+    for (; n < window_size; n++) {
+        sdft.update(sinf(M_2PI * freq_hz * n / sample_rate_hz));
+    }
+    // not enough samples to start
+    SlidingDFT empty;
+    ASSERT_TRUE(empty.init(window_size, sample_rate_hz));
+    EXPECT_FALSE(empty.start(10));
+
+    ASSERT_TRUE(sdft.start(lrintf(freq_hz / (sample_rate_hz / window_size))));
+    for (uint32_t i = 0; i < window_size; i++) {
+        sdft.update(0.001f * sinf(M_2PI * 31 * i / sample_rate_hz));
+    }
+    EXPECT_FALSE(sdft.track());
+    EXPECT_FALSE(sdft.is_locked());
+}
+
+AP_GTEST_MAIN()
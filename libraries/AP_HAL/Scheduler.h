@@ -79,6 +79,12 @@ public:
 
     virtual bool     in_main_thread() const = 0;
 
+    /*
+      return an opaque identifier for the calling thread, or nullptr
+      if the HAL can't identify threads
+     */
+    virtual const void *thread_ctx() const { return nullptr; }
+
     /*
       disable interrupts and return a context that can be used to
       restore the interrupt state. This can be used to protect
@@ -90,6 +90,19 @@ size_t AP_HAL::UARTDriver::write(const uint8_t *buffer, size_t size)
     return _write(buffer, size);
 }
 
+uint8_t AP_HAL::UARTDriver::write_reserve(ByteBuffer::IoVec vec[2], uint32_t size)
+{
+    if (lock_write_key != 0 || size == 0) {
+        return 0;
+    }
+    return _write_reserve(vec, size);
+}
+
+void AP_HAL::UARTDriver::write_commit(uint32_t len)
+{
+    _write_commit(len);
+}
+
 size_t AP_HAL::UARTDriver::write(uint8_t c)
 {
     return write(&c, 1);
@@ -4,6 +4,7 @@
 
 #include "AP_HAL_Namespace.h"
 #include "utility/BetterStream.h"
+#include "utility/RingBuffer.h"
 
 #ifndef HAL_UART_STATS_ENABLED
 #define HAL_UART_STATS_ENABLED !defined(HAL_NO_UARTDRIVER)
@@ -14,7 +15,6 @@
 #endif
 
 class ExpandingString;
-class ByteBuffer;
 
 /* Pure virtual UARTDriver class */
 class AP_HAL::UARTDriver : public AP_HAL::BetterStream {
@@ -48,6 +48,19 @@ public:
     size_t write(const uint8_t *buffer, size_t size) override;
     size_t write(const char *str) override;
 
+    /*
+      zero-copy write. write_reserve() fills in one or two regions of
+      the transmit buffer, totalling exactly size bytes, for the caller
+      to write into, and returns the number of regions. write_commit()
+      then queues the first len bytes of those regions for
+      transmission. Nothing else may be written to the port between
+      the two calls. Returns 0 if there is not enough space, the port
+      is locked or the backend doesn't support it, in which case
+      write() should be used instead
+     */
+    uint8_t write_reserve(ByteBuffer::IoVec vec[2], uint32_t size);
+    void write_commit(uint32_t len);
+
     /*
       single and multi-byte read methods
      */
@@ -195,6 +208,14 @@ protected:
      */
     virtual size_t _write(const uint8_t *buffer, size_t size) = 0;
 
+    /*
+      backend zero-copy write methods. A backend which can reserve
+      space must hold its write lock from a successful
+      _write_reserve() until _write_commit()
+     */
+    virtual uint8_t _write_reserve(ByteBuffer::IoVec vec[2], uint32_t size) { return 0; }
+    virtual void _write_commit(uint32_t len) {}
+
     /*
       backend read method
      */
@@ -395,8 +395,9 @@
 #define HAL_WITH_EKF_DOUBLE HAL_HAVE_HARDWARE_DOUBLE
 #endif
 
+// GyroFFT uses the SSE/NEON FFT in Linux::DSP
 #ifndef HAL_GYROFFT_ENABLED
-#define HAL_GYROFFT_ENABLED 0
+#define HAL_GYROFFT_ENABLED 1
 #endif
 
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_NONE
@@ -0,0 +1,37 @@
+#include <AP_gtest.h>
+#include <AP_HAL/HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// peeking at an offset returns the same data as reading up to it,
+// including across the wrap of the buffer
+TEST(RingBuffer, PeekAtOffset)
+{
+    FloatBuffer buf(16);
+    float out[16];
+
+    // move the read pointer so that later writes wrap
+    for (uint8_t i=0; i<10; i++) {
+        EXPECT_TRUE(buf.push(-1.0f));
+    }
+    EXPECT_TRUE(buf.advance(10));
+
+    for (uint8_t i=0; i<12; i++) {
+        EXPECT_TRUE(buf.push(float(i)));
+    }
+    EXPECT_EQ(buf.peek(5, out, 16), 7U);
+    for (uint8_t i=0; i<7; i++) {
+        EXPECT_FLOAT_EQ(out[i], float(i+5));
+    }
+    EXPECT_EQ(buf.peek(10, out, 1), 1U);
+    EXPECT_FLOAT_EQ(out[0], 10.0f);
+    EXPECT_EQ(buf.peek(12, out, 4), 0U);
+
+    // the read pointer is unchanged
+    EXPECT_EQ(buf.available(), 12U);
+    EXPECT_EQ(buf.peek(out, 1), 1U);
+    EXPECT_FLOAT_EQ(out[0], 0.0f);
+}
+
+AP_GTEST_MAIN()
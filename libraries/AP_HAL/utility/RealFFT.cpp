@@ -0,0 +1,374 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RealFFT.h"
+
+#include <math.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+  the butterflies are written once against these operations, so that the
+  same code runs four lanes at a time where SIMD is available and one
+  lane at a time for short stages and other hosts
+ */
+struct RealFFTScalar {
+    typedef float type;
+    static const uint8_t width = 1;
+    static type load(const float* p) { return *p; }
+    static void store(float* p, type v) { *p = v; }
+    static type set(float f) { return f; }
+    static type add(type a, type b) { return a + b; }
+    static type sub(type a, type b) { return a - b; }
+    static type mul(type a, type b) { return a * b; }
+    static type reverse(type a) { return a; }
+    static void store_interleaved(float* p, type re, type im) { p[0] = re; p[1] = im; }
+};
+
+#if defined(__SSE__)
+struct RealFFTVector {
+    typedef __m128 type;
+    static const uint8_t width = 4;
+    static type load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, type v) { _mm_storeu_ps(p, v); }
+    static type set(float f) { return _mm_set1_ps(f); }
+    static type add(type a, type b) { return _mm_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+    static type reverse(type a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3)); }
+    static void store_interleaved(float* p, type re, type im) {
+        _mm_storeu_ps(p, _mm_unpacklo_ps(re, im));
+        _mm_storeu_ps(p + 4, _mm_unpackhi_ps(re, im));
+    }
+};
+#define REALFFT_SIMD_ENABLED 1
+#elif defined(__ARM_NEON)
+struct RealFFTVector {
+    typedef float32x4_t type;
+    static const uint8_t width = 4;
+    static type load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, type v) { vst1q_f32(p, v); }
+    static type set(float f) { return vdupq_n_f32(f); }
+    static type add(type a, type b) { return vaddq_f32(a, b); }
+    static type sub(type a, type b) { return vsubq_f32(a, b); }
+    static type mul(type a, type b) { return vmulq_f32(a, b); }
+    static type reverse(type a) {
+        const float32x4_t r = vrev64q_f32(a);
+        return vcombine_f32(vget_high_f32(r), vget_low_f32(r));
+    }
+    static void store_interleaved(float* p, type re, type im) {
+        const float32x4x2_t v { { re, im } };
+        vst2q_f32(p, v);
+    }
+};
+#define REALFFT_SIMD_ENABLED 1
+#else
+typedef RealFFTScalar RealFFTVector;
+#define REALFFT_SIMD_ENABLED 0
+#endif
+
+RealFFT::~RealFFT()
+{
+    free_tables();
+}
+
+void RealFFT::free_tables()
+{
+    delete[] _bitrev;
+    delete[] _twiddles;
+    delete[] _unpack_re;
+    delete[] _unpack_im;
+    delete[] _re;
+    delete[] _im;
+    _bitrev = nullptr;
+    _twiddles = nullptr;
+    _unpack_re = nullptr;
+    _unpack_im = nullptr;
+    _re = nullptr;
+    _im = nullptr;
+}
+
+bool RealFFT::simd_enabled()
+{
+    return REALFFT_SIMD_ENABLED;
+}
+
+// allocate tables for a power of two window of at least 8 samples, returns false on failure
+bool RealFFT::init(uint16_t window_size)
+{
+    free_tables();
+
+    if (window_size < 8 || (window_size & (window_size - 1)) != 0) {
+        return false;
+    }
+    _window_size = window_size;
+    _fft_size = window_size / 2;
+
+    uint8_t log2_size = 0;
+    while ((1U << log2_size) < _fft_size) {
+        log2_size++;
+    }
+
+    // an odd power of two needs a single radix-2 stage, the radix-4 stages
+    // after the first then start at sub-FFTs of 2 or 4 samples
+    _radix2_first = (log2_size & 1) != 0;
+    const uint16_t first_h = _radix2_first ? 2 : 4;
+    uint32_t num_twiddles = 0;
+    for (uint32_t h = first_h; h < _fft_size; h *= 4) {
+        num_twiddles += 6 * h;
+    }
+
+    _bitrev = new uint16_t[_fft_size];
+    _twiddles = new float[num_twiddles + 1];
+    _unpack_re = new float[_fft_size / 2 + 1];
+    _unpack_im = new float[_fft_size / 2 + 1];
+    _re = new float[_fft_size];
+    _im = new float[_fft_size];
+    if (_bitrev == nullptr || _twiddles == nullptr || _unpack_re == nullptr || _unpack_im == nullptr
+        || _re == nullptr || _im == nullptr) {
+        free_tables();
+        return false;
+    }
+
+    for (uint16_t i = 0; i < _fft_size; i++) {
+        uint16_t r = 0;
+        for (uint8_t b = 0; b < log2_size; b++) {
+            r = (r << 1) | ((i >> b) & 1);
+        }
+        _bitrev[i] = r;
+    }
+
+    // calculated in double so that the tables do not add to the error of the transform
+    float* tw = _twiddles;
+    for (uint32_t h = first_h; h < _fft_size; h *= 4) {
+        for (uint32_t j = 0; j < h; j++) {
+            const double w = 2.0 * M_PI * j / (4 * h);
+            tw[j] = cos(w);
+            tw[h + j] = sin(w);
+            tw[2 * h + j] = cos(2 * w);
+            tw[3 * h + j] = sin(2 * w);
+            tw[4 * h + j] = cos(3 * w);
+            tw[5 * h + j] = sin(3 * w);
+        }
+        tw += 6 * h;
+    }
+
+    for (uint16_t k = 0; k <= _fft_size / 2; k++) {
+        const double w = 2.0 * M_PI * k / _window_size;
+        _unpack_re[k] = cos(w);
+        _unpack_im[k] = sin(w);
+    }
+
+    return true;
+}
+
+// radix-2 butterflies combining sub-FFTs of length 1
+void RealFFT::radix2_first_stage()
+{
+    for (uint16_t b = 0; b < _fft_size; b += 2) {
+        const float re = _re[b + 1];
+        const float im = _im[b + 1];
+        _re[b + 1] = _re[b] - re;
+        _im[b + 1] = _im[b] - im;
+        _re[b] += re;
+        _im[b] += im;
+    }
+}
+
+// first radix-4 stage, where the twiddles are all one
+void RealFFT::radix4_first_stage()
+{
+    for (uint16_t b = 0; b < _fft_size; b += 4) {
+        // in bit reversed order the second input is the odd sub-FFT of the even samples
+        const float sr = _re[b] + _re[b + 1];
+        const float si = _im[b] + _im[b + 1];
+        const float dr = _re[b] - _re[b + 1];
+        const float di = _im[b] - _im[b + 1];
+        const float ur = _re[b + 2] + _re[b + 3];
+        const float ui = _im[b + 2] + _im[b + 3];
+        const float vr = _re[b + 2] - _re[b + 3];
+        const float vi = _im[b + 2] - _im[b + 3];
+        _re[b] = sr + ur;
+        _im[b] = si + ui;
+        _re[b + 1] = dr - vi;
+        _im[b + 1] = di + vr;
+        _re[b + 2] = sr - ur;
+        _im[b + 2] = si - ui;
+        _re[b + 3] = dr + vi;
+        _im[b + 3] = di - vr;
+    }
+}
+
+// radix-4 butterflies combining sub-FFTs of length h
+template <typename V>
+void RealFFT::radix4_stage(uint16_t h, const float* twiddles)
+{
+    typedef typename V::type T;
+
+    const float* w1re = twiddles;
+    const float* w1im = twiddles + h;
+    const float* w2re = twiddles + 2 * h;
+    const float* w2im = twiddles + 3 * h;
+    const float* w3re = twiddles + 4 * h;
+    const float* w3im = twiddles + 5 * h;
+
+    for (uint16_t b = 0; b < _fft_size; b += 4 * h) {
+        float* re0 = &_re[b];
+        float* im0 = &_im[b];
+        float* re1 = re0 + h;
+        float* im1 = im0 + h;
+        float* re2 = re1 + h;
+        float* im2 = im1 + h;
+        float* re3 = re2 + h;
+        float* im3 = im2 + h;
+
+        for (uint16_t j = 0; j < h; j += V::width) {
+            // in bit reversed order the second sub-FFT holds the samples at 4n+2
+            // and the third those at 4n+1, so they take W^2j and W^j respectively
+            const T a0r = V::load(re0 + j);
+            const T a0i = V::load(im0 + j);
+            const T a1r = V::load(re1 + j);
+            const T a1i = V::load(im1 + j);
+            const T a2r = V::load(re2 + j);
+            const T a2i = V::load(im2 + j);
+            const T a3r = V::load(re3 + j);
+            const T a3i = V::load(im3 + j);
+
+            T wr = V::load(w1re + j);
+            T wi = V::load(w1im + j);
+            const T b1r = V::sub(V::mul(a2r, wr), V::mul(a2i, wi));
+            const T b1i = V::add(V::mul(a2r, wi), V::mul(a2i, wr));
+            wr = V::load(w2re + j);
+            wi = V::load(w2im + j);
+            const T b2r = V::sub(V::mul(a1r, wr), V::mul(a1i, wi));
+            const T b2i = V::add(V::mul(a1r, wi), V::mul(a1i, wr));
+            wr = V::load(w3re + j);
+            wi = V::load(w3im + j);
+            const T b3r = V::sub(V::mul(a3r, wr), V::mul(a3i, wi));
+            const T b3i = V::add(V::mul(a3r, wi), V::mul(a3i, wr));
+
+            const T sr = V::add(a0r, b2r);
+            const T si = V::add(a0i, b2i);
+            const T dr = V::sub(a0r, b2r);
+            const T di = V::sub(a0i, b2i);
+            const T ur = V::add(b1r, b3r);
+            const T ui = V::add(b1i, b3i);
+            const T vr = V::sub(b1r, b3r);
+            const T vi = V::sub(b1i, b3i);
+
+            V::store(re0 + j, V::add(sr, ur));
+            V::store(im0 + j, V::add(si, ui));
+            // d + jv
+            V::store(re1 + j, V::sub(dr, vi));
+            V::store(im1 + j, V::add(di, vr));
+            V::store(re2 + j, V::sub(sr, ur));
+            V::store(im2 + j, V::sub(si, ui));
+            // d - jv
+            V::store(re3 + j, V::add(dr, vi));
+            V::store(im3 + j, V::sub(di, vr));
+        }
+    }
+}
+
+/*
+  unpack bins k and N/2 - k of the half length complex FFT Z into the spectrum
+  of the real window, for k from start while the whole vector is <= end.
+  With E and O the spectra of the even and odd samples:
+    E[k] = (Z[k] + conj(Z[N/2-k])) / 2
+    O[k] = (Z[k] - conj(Z[N/2-k])) / 2j
+    X[k] = E[k] + e^(j2pik/N) * O[k]
+    X[N/2-k] = conj(E[k] - e^(j2pik/N) * O[k])
+  Returns the first k not unpacked
+ */
+template <typename V>
+uint16_t RealFFT::unpack(float* cplx, float* power, uint16_t k, uint16_t end)
+{
+    typedef typename V::type T;
+
+    const T half = V::set(0.5f);
+    for (; k + V::width - 1 <= end; k += V::width) {
+        // the mirrored bins, lowest index last so that they line up with k
+        const uint16_t m = _fft_size - k - (V::width - 1);
+        const T zr = V::load(&_re[k]);
+        const T zi = V::load(&_im[k]);
+        const T mr = V::reverse(V::load(&_re[m]));
+        const T mi = V::reverse(V::load(&_im[m]));
+
+        const T er = V::mul(V::add(zr, mr), half);
+        const T ei = V::mul(V::sub(zi, mi), half);
+        const T or_ = V::mul(V::add(zi, mi), half);
+        const T oi = V::mul(V::sub(mr, zr), half);
+
+        const T wr = V::load(&_unpack_re[k]);
+        const T wi = V::load(&_unpack_im[k]);
+        const T tr = V::sub(V::mul(wr, or_), V::mul(wi, oi));
+        const T ti = V::add(V::mul(wr, oi), V::mul(wi, or_));
+
+        const T xr = V::add(er, tr);
+        const T xi = V::add(ei, ti);
+        const T yr = V::sub(er, tr);
+        const T yi = V::sub(ti, ei);
+
+        V::store_interleaved(&cplx[2 * k], xr, xi);
+        V::store_interleaved(&cplx[2 * m], V::reverse(yr), V::reverse(yi));
+        V::store(&power[k], V::add(V::mul(xr, xr), V::mul(xi, xi)));
+        V::store(&power[m], V::reverse(V::add(V::mul(yr, yr), V::mul(yi, yi))));
+    }
+    return k;
+}
+
+// calculate the spectrum of window_size samples
+void RealFFT::transform(const float* samples, float* cplx, float* power)
+{
+    // pack pairs of samples into complex samples in bit reversed order
+    for (uint16_t n = 0; n < _fft_size; n++) {
+        _re[_bitrev[n]] = samples[2 * n];
+        _im[_bitrev[n]] = samples[2 * n + 1];
+    }
+
+    uint16_t h;
+    if (_radix2_first) {
+        radix2_first_stage();
+        h = 2;
+    } else {
+        radix4_first_stage();
+        h = 4;
+    }
+
+    const float* tw = _twiddles;
+    for (; h < _fft_size; h *= 4) {
+        if (h < RealFFTVector::width) {
+            radix4_stage<RealFFTScalar>(h, tw);
+        } else {
+            radix4_stage<RealFFTVector>(h, tw);
+        }
+        tw += 6 * h;
+    }
+
+    // DC and nyquist are real only
+    cplx[0] = _re[0] + _im[0];
+    cplx[1] = 0.0f;
+    cplx[2 * _fft_size] = _re[0] - _im[0];
+    cplx[2 * _fft_size + 1] = 0.0f;
+    power[0] = cplx[0] * cplx[0];
+
+    // the bin at N/4 is its own mirror and is unpacked twice to the same values
+    const uint16_t k = unpack<RealFFTVector>(cplx, power, 1, _fft_size / 2);
+    unpack<RealFFTScalar>(cplx, power, k, _fft_size / 2);
+}
@@ -0,0 +1,83 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <AP_Common/AP_Common.h>
+
+/*
+  FFT of a window of real samples for hosts without a vendor DSP library.
+
+  The window is packed into a complex FFT of half its length, which is
+  calculated with radix-4 butterflies (and a single radix-2 stage when
+  needed) using SSE or NEON where available, then unpacked into the
+  spectrum of the real window. Twiddles and the bit reversal table are
+  calculated once in init().
+
+  The sign convention matches the reference FFT in AP_HAL_SITL, X[k] is
+  the sum of x[n] * e^(j2pikn/N).
+ */
+class RealFFT {
+public:
+    RealFFT() {}
+    ~RealFFT();
+
+    CLASS_NO_COPY(RealFFT);
+
+    // allocate tables for a power of two window of at least 8 samples, returns false on failure
+    bool init(uint16_t window_size);
+
+    // calculate the spectrum of window_size samples. cplx receives the window_size / 2 + 1
+    // complex bins from DC to nyquist as interleaved real and imaginary parts, power
+    // receives the squared magnitude of the window_size / 2 bins below nyquist.
+    // power may be the same array as samples
+    void transform(const float* samples, float* cplx, float* power);
+
+    uint16_t get_window_size() const { return _window_size; }
+
+    // true if the butterflies use SSE or NEON
+    static bool simd_enabled();
+
+private:
+    // radix-4 butterflies combining sub-FFTs of length h
+    template <typename V> void radix4_stage(uint16_t h, const float* twiddles);
+    // first radix-4 stage, where the twiddles are all one
+    void radix4_first_stage();
+    // radix-2 butterflies combining sub-FFTs of length 1
+    void radix2_first_stage();
+    // unpack the half length complex FFT into the spectrum of the real window
+    template <typename V> uint16_t unpack(float* cplx, float* power, uint16_t k, uint16_t end);
+
+    void free_tables();
+
+    uint16_t _window_size;
+    // length of the complex FFT, half the window
+    uint16_t _fft_size;
+    // true if the length of the complex FFT is an odd power of two
+    bool _radix2_first;
+
+    // bit reversed index for each complex sample
+    uint16_t* _bitrev = nullptr;
+    // for each radix-4 stage after the first, the real and imaginary
+    // parts of W^j, W^2j and W^3j for j < h
+    float* _twiddles = nullptr;
+    // real and imaginary parts of e^(j2pik/N) for k <= N/4, used when unpacking
+    float* _unpack_re = nullptr;
+    float* _unpack_im = nullptr;
+
+    // complex FFT data, split into real and imaginary parts
+    float* _re = nullptr;
+    float* _im = nullptr;
+};
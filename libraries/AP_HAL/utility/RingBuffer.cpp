@@ -196,6 +196,22 @@ uint32_t ByteBuffer::peekbytes(uint8_t *data, uint32_t len)
     return ret;
 }
 
+uint32_t ByteBuffer::peekbytes(uint32_t ofs, uint8_t *data, uint32_t len)
+{
+    const uint32_t n = available();
+    if (ofs >= n) {
+        return 0;
+    }
+    if (len > n - ofs) {
+        len = n - ofs;
+    }
+    const uint32_t start = (head + ofs) % size;
+    const uint32_t n1 = len < size - start ? len : size - start;
+    memcpy(data, &buf[start], n1);
+    memcpy(data + n1, buf, len - n1);
+    return len;
+}
+
 uint8_t ByteBuffer::reserve(ByteBuffer::IoVec iovec[2], uint32_t len)
 {
     uint32_t n = space();
@@ -70,6 +70,12 @@ public:
     */
     uint32_t peekbytes(uint8_t *data, uint32_t len);
 
+    /*
+      read len bytes starting ofs bytes after the read pointer, without
+      advancing the read pointer
+    */
+    uint32_t peekbytes(uint32_t ofs, uint8_t *data, uint32_t len);
+
     // Similar to peekbytes(), but will fill out IoVec struct with
     // both parts of the ring buffer if wraparound is happening, or
     // just one part. Returns the number of parts written to.
@@ -145,6 +151,9 @@ public:
     // read len objects without advancing the read pointer
     uint32_t peek(T *data, uint32_t len) { return buffer->peekbytes((uint8_t*)data, len * sizeof(T)) / sizeof(T); }
 
+    // read len objects starting ofs objects after the read pointer, without advancing the read pointer
+    uint32_t peek(uint32_t ofs, T *data, uint32_t len) { return buffer->peekbytes(ofs * sizeof(T), (uint8_t*)data, len * sizeof(T)) / sizeof(T); }
+
     // Discards the buffer content, emptying it.
     // !!! Note ObjectBuffer_TS is a duplicate of this update, in both places !!!
     void clear(void)
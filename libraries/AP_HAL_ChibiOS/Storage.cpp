@@ -22,6 +22,7 @@
 #include "Scheduler.h"
 #include "hwdef/common/flash.h"
 #include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Common/ExpandingString.h>
 #include <stdio.h>
 
 using namespace ChibiOS;
@@ -239,8 +240,14 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
         WITH_SEMAPHORE(sem);
+        _stats.write_calls++;
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _last_dirty_ms = AP_HAL::millis();
+    } else {
+        WITH_SEMAPHORE(sem);
+        _stats.write_calls++;
+        _stats.write_unchanged++;
     }
 }
 
@@ -249,13 +256,22 @@ void Storage::_timer_tick(void)
     if (_initialisedType == StorageBackend::None) {
         return;
     }
+    const uint32_t now_ms = AP_HAL::millis();
     if (_dirty_mask.empty()) {
-        _last_empty_ms = AP_HAL::millis();
+        _last_empty_ms = now_ms;
+        return;
+    }
+
+    // while writes are still arriving hold off, so that repeated
+    // writes to the same lines are combined into one backend write,
+    // but don't let lines stay dirty for too long
+    if (now_ms - _last_dirty_ms < HAL_STORAGE_COMBINE_MS &&
+        now_ms - _last_empty_ms < HAL_STORAGE_COMBINE_MAX_MS) {
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
+    // write out the first run of dirty lines. We don't write more
+    // than one run to keep the latency of this call to a minimum
     uint16_t i;
     for (i=0; i<CH_STORAGE_NUM_LINES; i++) {
         if (_dirty_mask.get(i)) {
@@ -266,18 +282,26 @@ void Storage::_timer_tick(void)
         // this shouldn't be possible
         return;
     }
+    uint16_t num_lines = 1;
+    while (num_lines < CH_STORAGE_COMBINE_SIZE/CH_STORAGE_LINE_SIZE &&
+           i+num_lines < CH_STORAGE_NUM_LINES &&
+           _dirty_mask.get(i+num_lines)) {
+        num_lines++;
+    }
+    const uint32_t offset = CH_STORAGE_LINE_SIZE*i;
+    const uint16_t length = CH_STORAGE_LINE_SIZE*num_lines;
 
     {
-        // take a copy of the line we are writing with a semaphore held
+        // take a copy of the lines we are writing with a semaphore held
         WITH_SEMAPHORE(sem);
-        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE);
+        memcpy(tmpline, &_buffer[offset], length);
     }
 
     bool write_ok = false;
 
 #if HAL_WITH_RAMTRON
     if (_initialisedType == StorageBackend::FRAM) {
-        if (fram.write(CH_STORAGE_LINE_SIZE*i, tmpline, CH_STORAGE_LINE_SIZE)) {
+        if (fram.write(offset, tmpline, length)) {
             write_ok = true;
         }
     }
@@ -285,39 +309,39 @@ void Storage::_timer_tick(void)
 
 #ifdef USE_POSIX
     if ((_initialisedType == StorageBackend::SDCard) && log_fd != -1) {
-        uint32_t offset = CH_STORAGE_LINE_SIZE*i;
-        if (AP::FS().lseek(log_fd, offset, SEEK_SET) != offset) {
-            return;
-        }
-        if (AP::FS().write(log_fd, &_buffer[offset], CH_STORAGE_LINE_SIZE) != CH_STORAGE_LINE_SIZE) {
-            return;
-        }
-        if (AP::FS().fsync(log_fd) != 0) {
-            return;
+        if (AP::FS().lseek(log_fd, offset, SEEK_SET) == offset &&
+            AP::FS().write(log_fd, tmpline, length) == length &&
+            AP::FS().fsync(log_fd) == 0) {
+            write_ok = true;
         }
-        write_ok = true;
     }
 #endif
 
 #ifdef STORAGE_FLASH_PAGE
     if (_initialisedType == StorageBackend::Flash) {
         // save to storage backend
-        if (_flash_write(i)) {
+        if (_flash_write(i, num_lines)) {
             write_ok = true;
         }
     }
 #endif
 
-    if (write_ok) {
-        WITH_SEMAPHORE(sem);
-        // while holding the semaphore we check if the copy of the
-        // line is different from the original line. If it is
-        // different then someone has re-dirtied the line while we
-        // were writing it, in which case we should not mark it
-        // clean. If it matches then we know we can mark the line as
-        // clean
-        if (memcmp(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE) == 0) {
-            _dirty_mask.clear(i);
+    WITH_SEMAPHORE(sem);
+    if (!write_ok) {
+        _stats.write_fails++;
+        return;
+    }
+    _stats.backend_writes++;
+    _stats.lines_written += num_lines;
+
+    // while holding the semaphore we check if the copy of each
+    // line is different from the original line. If it is different
+    // then someone has re-dirtied the line while we were writing it,
+    // in which case we should not mark it clean. If it matches then
+    // we know we can mark the line as clean
+    for (uint16_t j=0; j<num_lines; j++) {
+        if (memcmp(&tmpline[CH_STORAGE_LINE_SIZE*j], &_buffer[offset+CH_STORAGE_LINE_SIZE*j], CH_STORAGE_LINE_SIZE) == 0) {
+            _dirty_mask.clear(i+j);
         }
     }
 }
@@ -341,13 +365,13 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask.
+  write a run of storage lines
 */
-bool Storage::_flash_write(uint16_t line)
+bool Storage::_flash_write(uint16_t line, uint16_t num_lines)
 {
 #ifdef STORAGE_FLASH_PAGE
     EXPECT_DELAY_MS(1);
-    return _flash.write(line*CH_STORAGE_LINE_SIZE, CH_STORAGE_LINE_SIZE);
+    return _flash.write(line*CH_STORAGE_LINE_SIZE, num_lines*CH_STORAGE_LINE_SIZE);
 #else
     return false;
 #endif
@@ -416,6 +440,8 @@ bool Storage::_flash_erase_sector(uint8_t sector)
          */
         EXPECT_DELAY_MS(1000);
         if (hal.flash->erasepage(_flash_page+sector)) {
+            WITH_SEMAPHORE(sem);
+            _stats.erases++;
             return true;
         }
         hal.scheduler->delay(1);
@@ -486,5 +512,28 @@ bool Storage::get_storage_ptr(void *&ptr, size_t &size)
     return true;
 }
 
+/*
+  report write combining and wear statistics
+ */
+void Storage::get_stats(ExpandingString &str)
+{
+    StorageStats stats;
+    uint16_t dirty_lines;
+    {
+        WITH_SEMAPHORE(sem);
+        stats = _stats;
+        dirty_lines = _dirty_mask.count();
+    }
+    // a header to allow for machine parsers to determine format
+    str.printf("STORAGEV1\n");
+    str.printf("writes:%u unchanged:%u lines:%u backend_writes:%u fails:%u erases:%u dirty:%u\n",
+               unsigned(stats.write_calls),
+               unsigned(stats.write_unchanged),
+               unsigned(stats.lines_written),
+               unsigned(stats.backend_writes),
+               unsigned(stats.write_fails),
+               unsigned(stats.erases),
+               unsigned(dirty_lines));
+}
 
 #endif // HAL_USE_EMPTY_STORAGE
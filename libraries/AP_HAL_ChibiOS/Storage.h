@@ -47,6 +47,30 @@
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
+// adjacent dirty lines are written to the backend as a single run of
+// up to this many bytes. On F4/F7 flash this matches the AP_FlashStorage
+// max_write so a run costs one block header instead of one per line. On
+// H7 and G4 AP_FlashStorage splits runs into 30 and 6 byte writes, each
+// with its own header, so combining only saves the flash erase churn
+// of rewriting the same lines
+#if CH_STORAGE_LINE_SIZE >= 64
+#define CH_STORAGE_COMBINE_SIZE CH_STORAGE_LINE_SIZE
+#else
+#define CH_STORAGE_COMBINE_SIZE 64
+#endif
+
+// writes are held back until storage has been quiet for this long, so
+// that a burst of small writes to the same lines (a parameter save or
+// a mission upload) is flushed once
+#ifndef HAL_STORAGE_COMBINE_MS
+#define HAL_STORAGE_COMBINE_MS 50
+#endif
+
+// maximum time a line can stay dirty while writes keep arriving
+#ifndef HAL_STORAGE_COMBINE_MAX_MS
+#define HAL_STORAGE_COMBINE_MAX_MS 500
+#endif
+
 class ChibiOS::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -57,6 +81,7 @@ public:
     void _timer_tick(void) override;
     bool healthy(void) override;
     bool get_storage_ptr(void *&ptr, size_t &size) override;
+    void get_stats(ExpandingString &str) override;
 
 private:
     enum class StorageBackend: uint8_t {
@@ -73,7 +98,20 @@ private:
     uint8_t _buffer[CH_STORAGE_SIZE] __attribute__((aligned(4)));
     Bitmask<CH_STORAGE_NUM_LINES> _dirty_mask;
     HAL_Semaphore sem;
-    uint8_t tmpline[CH_STORAGE_LINE_SIZE];
+    uint8_t tmpline[CH_STORAGE_COMBINE_SIZE];
+
+    // time of the last write that dirtied a line
+    uint32_t _last_dirty_ms;
+
+    // statistics for get_stats(), protected by sem
+    struct StorageStats {
+        uint32_t write_calls;     // calls to write_block()
+        uint32_t write_unchanged; // calls that changed no data
+        uint32_t lines_written;   // lines written to the backend
+        uint32_t backend_writes;  // write operations on the backend
+        uint32_t write_fails;     // failed backend writes
+        uint32_t erases;          // flash sector erases
+    } _stats;
 
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
@@ -94,7 +132,7 @@ private:
 #endif
 
     void _flash_load(void);
-    bool _flash_write(uint16_t line);
+    bool _flash_write(uint16_t line, uint16_t num_lines);
 
 #if HAL_WITH_RAMTRON
     AP_RAMTRON fram;
@@ -733,6 +733,32 @@ size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
     return ret;
 }
 
+/*
+  reserve space in the transmit buffer for the caller to write
+  into. The write mutex is held until _write_commit()
+ */
+uint8_t UARTDriver::_write_reserve(ByteBuffer::IoVec vec[2], uint32_t size)
+{
+    if (!_tx_initialised) {
+        return 0;
+    }
+    _write_mutex.take_blocking();
+    if (_writebuf.space() < size) {
+        _write_mutex.give();
+        return 0;
+    }
+    return _writebuf.reserve(vec, size);
+}
+
+void UARTDriver::_write_commit(uint32_t len)
+{
+    _writebuf.commit(len);
+    if (unbuffered_writes) {
+        chEvtSignal(uart_thread_ctx, EVT_TRANSMIT_DATA_READY);
+    }
+    _write_mutex.give();
+}
+
 /*
   wait for data to arrive, or a timeout. Return true if data has
   arrived, false on timeout
@@ -272,6 +272,8 @@ protected:
     void _end() override;
     void _flush() override;
     size_t _write(const uint8_t *buffer, size_t size) override;
+    uint8_t _write_reserve(ByteBuffer::IoVec vec[2], uint32_t size) override;
+    void _write_commit(uint32_t len) override;
     ssize_t _read(uint8_t *buffer, uint16_t count) override;
     uint32_t _available() override;
     bool _discard_input() override;
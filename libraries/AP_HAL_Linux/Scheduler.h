@@ -33,6 +33,7 @@ public:
     void     register_io_process(AP_HAL::MemberProc) override;
 
     bool     in_main_thread() const override;
+    const void *thread_ctx() const override { return (const void *)(uintptr_t)pthread_self(); }
 
     void     register_timer_failsafe(AP_HAL::Proc, uint32_t period_us) override;
 
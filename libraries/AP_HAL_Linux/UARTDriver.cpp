@@ -299,6 +299,31 @@ size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
     return ret;
 }
 
+/*
+  reserve space in the transmit buffer for the caller to write
+  into. The write mutex is held until _write_commit()
+ */
+uint8_t UARTDriver::_write_reserve(ByteBuffer::IoVec vec[2], uint32_t size)
+{
+    if (!_initialised) {
+        return 0;
+    }
+    if (!_write_mutex.take_nonblocking()) {
+        return 0;
+    }
+    if (_writebuf.space() < size) {
+        _write_mutex.give();
+        return 0;
+    }
+    return _writebuf.reserve(vec, size);
+}
+
+void UARTDriver::_write_commit(uint32_t len)
+{
+    _writebuf.commit(len);
+    _write_mutex.give();
+}
+
 /*
   try writing n bytes, handling an unresponsive port
  */
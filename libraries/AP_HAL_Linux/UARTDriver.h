@@ -94,6 +94,8 @@ protected:
     void _flush() override;
     uint32_t _available() override;
     size_t _write(const uint8_t *buffer, size_t size) override;
+    uint8_t _write_reserve(ByteBuffer::IoVec vec[2], uint32_t size) override;
+    void _write_commit(uint32_t len) override;
     ssize_t _read(uint8_t *buffer, uint16_t count) override WARN_IF_UNUSED;
 };
 
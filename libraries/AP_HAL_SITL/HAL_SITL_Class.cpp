@@ -231,6 +231,11 @@ void HAL_SITL::run(int argc, char * const argv[], Callbacks* callbacks) const
             // don't wipe params on reboot
             continue;
         }
+        if (!strcmp(argv[i], "--storage-restore")) {
+            // don't go back to the snapshot on reboot
+            i++;
+            continue;
+        }
         new_argv[new_argv_offset++] = argv[i];
     }
     
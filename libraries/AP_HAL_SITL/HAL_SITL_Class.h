@@ -35,6 +35,19 @@ public:
     }
     bool get_wipe_storage() const { return wipe_storage; }
 
+    /*
+      storage image to load as storage is opened, and storage image
+      to save to on SIGUSR1
+     */
+    void set_storage_restore(const char *_path) {
+        storage_restore = _path;
+    }
+    const char *get_storage_restore() const { return storage_restore; }
+    void set_storage_snapshot(const char *_path) {
+        storage_snapshot = _path;
+    }
+    const char *get_storage_snapshot() const { return storage_snapshot; }
+
     uint8_t get_instance() const;
 
 #if defined(HAL_BUILD_AP_PERIPH)
@@ -53,6 +66,9 @@ private:
 
     // set to true if simulation is to wipe storage as it is opened:
     bool wipe_storage;
+
+    const char *storage_restore;
+    const char *storage_snapshot;
 };
 
 #if HAL_NUM_CAN_IFACES
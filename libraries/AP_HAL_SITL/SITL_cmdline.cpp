@@ -119,6 +119,8 @@ void SITL_State::_usage(void)
            "\t--start-time TIMESTR     set simulation start time in UNIX timestamp\n"
            "\t--sysid ID               set SYSID_THISMAV\n"
            "\t--slave number           set the number of JSON slaves\n"
+           "\t--storage-restore PATH   start from storage image PATH\n"
+           "\t--storage-snapshot PATH  save storage image to PATH on SIGUSR1\n"
         );
 }
 
@@ -273,6 +275,8 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_START_TIME,
         CMDLINE_SYSID,
         CMDLINE_SLAVE,
+        CMDLINE_STORAGE_RESTORE,
+        CMDLINE_STORAGE_SNAPSHOT,
 #if STORAGE_USE_FLASH
         CMDLINE_SET_STORAGE_FLASH_ENABLED,
 #endif
@@ -332,6 +336,8 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"start-time",      true,   0, CMDLINE_START_TIME},
         {"sysid",           true,   0, CMDLINE_SYSID},
         {"slave",           true,   0, CMDLINE_SLAVE},
+        {"storage-restore", true,   0, CMDLINE_STORAGE_RESTORE},
+        {"storage-snapshot", true,  0, CMDLINE_STORAGE_SNAPSHOT},
 #if STORAGE_USE_FLASH
         {"set-storage-flash-enabled", true,   0, CMDLINE_SET_STORAGE_FLASH_ENABLED},
 #endif
@@ -507,6 +513,12 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             printf("Setting SYSID_THISMAV=%d\n", sysid);
             break;
         }
+        case CMDLINE_STORAGE_RESTORE:
+            hal.set_storage_restore(gopt.optarg);
+            break;
+        case CMDLINE_STORAGE_SNAPSHOT:
+            hal.set_storage_snapshot(gopt.optarg);
+            break;
 #if STORAGE_USE_POSIX
         case CMDLINE_SET_STORAGE_POSIX_ENABLED:
             storage_posix_enabled = atoi(gopt.optarg);
@@ -10,6 +10,8 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <signal.h>
+#include <sys/mman.h>
 
 #ifndef HAL_STORAGE_FILE
 #if APM_BUILD_TYPE(APM_BUILD_Replay)
@@ -46,6 +48,14 @@ extern HAL_SITL& hal;
 #define HAL_FLASH_ALLOW_UPDATE 1
 #endif
 
+// set from the SIGUSR1 handler, the snapshot is saved from _timer_tick()
+static volatile sig_atomic_t snapshot_requested;
+
+static void sig_snapshot(int signum)
+{
+    snapshot_requested = 1;
+}
+
 void Storage::_storage_open(void)
 {
     if (_initialisedType != StorageBackend::None) {
@@ -53,6 +63,29 @@ void Storage::_storage_open(void)
         return;
     }
 
+    _storage_create();
+    if (_initialisedType == StorageBackend::None) {
+        return;
+    }
+
+    const char *restore = hal.get_storage_restore();
+    if (restore != nullptr && !_snapshot_restore(restore)) {
+        AP_HAL::panic("Failed to restore storage from %s", restore);
+    }
+
+    if (hal.get_storage_snapshot() != nullptr) {
+        struct sigaction sa = { };
+        sa.sa_handler = sig_snapshot;
+        sa.sa_flags = SA_RESTART;
+        sigaction(SIGUSR1, &sa, nullptr);
+    }
+}
+
+/*
+  open the storage backend and load the storage image from it
+ */
+void Storage::_storage_create(void)
+{
     _dirty_mask.clearall();
 
 #define HAL_RAMTRON_ALLOW_FALLBACK 0
@@ -111,6 +144,8 @@ void Storage::_storage_open(void)
             log_fd = -1;
             return;
         }
+        void *map = mmap(nullptr, HAL_STORAGE_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, log_fd, 0);
+        _mapped = (map == MAP_FAILED) ? nullptr : (uint8_t *)map;
         _initialisedType = StorageBackend::SDCard;  // AKA POSIX
         return;
     }
@@ -165,6 +200,13 @@ void Storage::_timer_tick(void)
     if (_initialisedType == StorageBackend::None) {
         return;
     }
+    if (snapshot_requested) {
+        snapshot_requested = 0;
+        const char *snapshot = hal.get_storage_snapshot();
+        if (snapshot != nullptr && !_snapshot_save(snapshot)) {
+            ::printf("Failed to save storage snapshot to %s\n", snapshot);
+        }
+    }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
         return;
@@ -192,6 +234,16 @@ void Storage::_timer_tick(void)
 
 #if STORAGE_USE_POSIX
     if (hal.get_storage_posix_enabled()) {
+        if (_mapped != nullptr) {
+            // with the file mapped all dirty lines can be flushed at once
+            for (; i<STORAGE_NUM_LINES; i++) {
+                if (_dirty_mask.get(i)) {
+                    memcpy(&_mapped[STORAGE_LINE_SIZE*i], &_buffer[STORAGE_LINE_SIZE*i], STORAGE_LINE_SIZE);
+                    _dirty_mask.clear(i);
+                }
+            }
+            return;
+        }
         if (log_fd != -1) {
             const off_t offset = STORAGE_LINE_SIZE*i;
             if (lseek(log_fd, offset, SEEK_SET) != offset) {
@@ -215,6 +267,51 @@ void Storage::_timer_tick(void)
 #endif
 }
 
+/*
+  load the storage image from a snapshot file. All lines are marked
+  dirty so the image is written through to the storage backend
+ */
+bool Storage::_snapshot_restore(const char *path)
+{
+    const int fd = open(path, O_RDONLY|O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    const bool ok = read(fd, _buffer, HAL_STORAGE_SIZE) == HAL_STORAGE_SIZE;
+    close(fd);
+    if (!ok) {
+        return false;
+    }
+    _mark_dirty(0, HAL_STORAGE_SIZE);
+    ::printf("Restored storage from %s\n", path);
+    return true;
+}
+
+/*
+  save the storage image to a snapshot file. The image is written to a
+  temporary file and renamed into place so that instances starting
+  from the snapshot never see a partial image
+ */
+bool Storage::_snapshot_save(const char *path)
+{
+    char tmp_path[256];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= int(sizeof(tmp_path))) {
+        return false;
+    }
+    const int fd = open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return false;
+    }
+    bool ok = write(fd, _buffer, HAL_STORAGE_SIZE) == HAL_STORAGE_SIZE;
+    ok = (close(fd) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return false;
+    }
+    ::printf("Saved storage snapshot to %s\n", path);
+    return true;
+}
+
 #if STORAGE_USE_FLASH
 
 /*
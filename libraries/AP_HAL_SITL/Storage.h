@@ -42,6 +42,11 @@ private:
     };
     StorageBackend _initialisedType = StorageBackend::None;
 
+    // load the storage image from a snapshot file, and save the
+    // current image to it. See --storage-snapshot
+    bool _snapshot_restore(const char *path);
+    bool _snapshot_save(const char *path);
+
     void _storage_create(void);
     void _storage_open(void);
     void _save_backup(void);
@@ -73,6 +78,9 @@ private:
 
 #if STORAGE_USE_POSIX
     int log_fd;
+    // storage file mapped into memory, so flushing a line is a memcpy
+    // rather than a seek and write
+    uint8_t *_mapped;
 #endif
 
 #if STORAGE_USE_FRAM
@@ -874,6 +874,17 @@ bool AP_InertialSensor::has_fft_notch() const
     }
     return false;
 }
+
+bool AP_InertialSensor::has_fft_notch_on_all_imus() const
+{
+    for (auto &notch : harmonic_notches) {
+        if (notch.params.enabled() && notch.params.tracking_mode() == HarmonicNotchDynamicMode::UpdateGyroFFT &&
+            notch.params.hasOption(HarmonicNotchFilterParams::Options::EnableOnAllIMUs)) {
+            return true;
+        }
+    }
+    return false;
+}
 #endif
 
 void
@@ -1728,7 +1739,8 @@ void AP_InertialSensor::_save_gyro_calibration()
  */
 void AP_InertialSensor::HarmonicNotch::update_params(uint8_t instance, bool converging, float gyro_rate)
 {
-    const float center_freq = calculated_notch_freq_hz[0];
+    const float center_freq = is_positive(calculated_imu_notch_freq_hz[instance]) ?
+        calculated_imu_notch_freq_hz[instance] : calculated_notch_freq_hz[0];
     if (!is_equal(last_bandwidth_hz[instance], params.bandwidth_hz()) ||
         !is_equal(last_attenuation_dB[instance], params.attenuation_dB()) ||
         (params.tracking_mode() == HarmonicNotchDynamicMode::Fixed && !is_equal(last_center_freq_hz[instance], center_freq)) ||
@@ -1741,7 +1753,7 @@ void AP_InertialSensor::HarmonicNotch::update_params(uint8_t instance, bool conv
         last_bandwidth_hz[instance] = params.bandwidth_hz();
         last_attenuation_dB[instance] = params.attenuation_dB();
     } else if (params.tracking_mode() != HarmonicNotchDynamicMode::Fixed) {
-        if (num_calculated_notch_frequencies > 1) {
+        if (num_calculated_notch_frequencies > 1 && !is_positive(calculated_imu_notch_freq_hz[instance])) {
             filter[instance].update(num_calculated_notch_frequencies, calculated_notch_freq_hz);
         } else {
             filter[instance].update(center_freq);
@@ -2186,6 +2198,15 @@ void AP_InertialSensor::HarmonicNotch::update_freq_hz(float scaled_freq)
         calculated_notch_freq_hz[0] = scaled_freq;
     }
     num_calculated_notch_frequencies = 1;
+    memset(calculated_imu_notch_freq_hz, 0, sizeof(calculated_imu_notch_freq_hz));
+}
+
+// Update the harmonic notch frequency of a single IMU
+void AP_InertialSensor::HarmonicNotch::update_imu_freq_hz(uint8_t instance, float scaled_freq)
+{
+    if (instance < INS_MAX_INSTANCES) {
+        calculated_imu_notch_freq_hz[instance] = MAX(scaled_freq, 0.0f);
+    }
 }
 
 // Update the harmonic notch frequency
@@ -2198,6 +2219,7 @@ void AP_InertialSensor::HarmonicNotch::update_frequencies_hz(uint8_t num_freqs,
     }
     // any uncalculated frequencies will float at the previous value or the initialized freq if none
     num_calculated_notch_frequencies = num_freqs;
+    memset(calculated_imu_notch_freq_hz, 0, sizeof(calculated_imu_notch_freq_hz));
 }
 
 // setup the notch for throttle based tracking, called from FFT based tuning
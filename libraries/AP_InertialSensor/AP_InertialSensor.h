@@ -157,6 +157,8 @@ public:
     uint16_t get_raw_gyro_rate_hz() const { return get_raw_gyro_rate_hz(_primary_gyro); }
     uint16_t get_raw_gyro_rate_hz(uint8_t instance) const { return _gyro_raw_sample_rates[_primary_gyro]; }
     bool has_fft_notch() const;
+    // true if an FFT tracking notch runs on every IMU rather than just the primary
+    bool has_fft_notch_on_all_imus() const;
 #endif
     bool set_gyro_window_size(uint16_t size);
     // get accel offsets in m/s/s
@@ -438,6 +440,9 @@ public:
         // Update the harmonic notch frequencies
         void update_freq_hz(float scaled_freq);
         void update_frequencies_hz(uint8_t num_freqs, const float scaled_freq[]);
+        // Update the harmonic notch frequency of a single IMU, overriding the
+        // frequency set by update_freq_hz() until it is next called
+        void update_imu_freq_hz(uint8_t instance, float scaled_freq);
 
         // enable/disable the notch
         void set_inactive(bool _inactive) {
@@ -453,6 +458,8 @@ public:
         float last_center_freq_hz[INS_MAX_INSTANCES];
         float last_bandwidth_hz[INS_MAX_INSTANCES];
         float last_attenuation_dB[INS_MAX_INSTANCES];
+        // per-IMU center frequency, zero to use calculated_notch_freq_hz
+        float calculated_imu_notch_freq_hz[INS_MAX_INSTANCES];
         bool inactive;
     } harmonic_notches[HAL_INS_NUM_HARMONIC_NOTCH_FILTERS];
 
@@ -5,6 +5,7 @@
 #include "AP_InertialSensor_Backend.h"
 #include <AP_Logger/AP_Logger.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_Scheduler/AP_Scheduler.h>
 #if AP_MODULE_SUPPORTED
 #include <AP_Module/AP_Module.h>
 #endif
@@ -774,11 +775,26 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance) /* front end */
         _last_gyro_filter_hz = _gyro_filter_cutoff();
     }
 
+#if AP_SCHEDULER_ENABLED
+    const uint32_t notch_start_us = AP_HAL::micros();
+    bool notch_updated = false;
+#endif
     for (auto &notch : _imu.harmonic_notches) {
         if (notch.params.enabled()) {
             notch.update_params(instance, sensors_converging(), gyro_rate);
+#if AP_SCHEDULER_ENABLED
+            notch_updated = true;
+#endif
         }
     }
+#if AP_SCHEDULER_ENABLED
+    // coefficient updates are part of the INS fast task, this reports
+    // how much of that task they take
+    AP_Scheduler *scheduler = AP_Scheduler::get_singleton();
+    if (notch_updated && scheduler != nullptr) {
+        scheduler->perf_info.update_notch_info(AP_HAL::micros() - notch_start_us);
+    }
+#endif
 }
 
 /*
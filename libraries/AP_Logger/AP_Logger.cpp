@@ -719,13 +719,162 @@ void AP_Logger::save_format_Replay(const void *pBuffer)
 void AP_Logger::WriteBlock(const void *pBuffer, uint16_t size) {
 #if APM_BUILD_TYPE(APM_BUILD_Replay)
     save_format_Replay(pBuffer);
+#endif
+#if HAL_LOGGER_STAGING_ENABLED
+    if (stage_block(pBuffer, size)) {
+        return;
+    }
 #endif
     FOR_EACH_BACKEND(WriteBlock(pBuffer, size));
 }
 
+#if HAL_LOGGER_STAGING_ENABLED
+/*
+  return the staging ring of the calling thread. If claim is true a
+  free ring is claimed on the first write from a thread. Returns
+  nullptr if the HAL can't identify threads or no ring is available
+ */
+AP_Logger::StagingRing *AP_Logger::staging_ring_for_thread(bool claim)
+{
+    const void *ctx = hal.scheduler->thread_ctx();
+    if (ctx == nullptr) {
+        return nullptr;
+    }
+    // only the owning thread claims a ring for ctx, so a lock-free
+    // scan of the published rings is sufficient
+    const uint8_t n = _num_staging_rings;
+    for (uint8_t i=0; i<n; i++) {
+        if (_staging_rings[i].owner == ctx) {
+            return &_staging_rings[i];
+        }
+    }
+    if (!claim) {
+        return nullptr;
+    }
+
+    WITH_SEMAPHORE(_staging_sem);
+    if (_staging_alloc_failed || _num_staging_rings >= HAL_LOGGER_STAGING_MAX_THREADS) {
+        return nullptr;
+    }
+    StagingRing &ring = _staging_rings[_num_staging_rings];
+    if (!ring.ring.init(HAL_LOGGER_STAGING_BUFSIZE)) {
+        _staging_alloc_failed = true;
+        return nullptr;
+    }
+    ring.owner = ctx;
+    // publish the ring to the drain
+    _num_staging_rings++;
+    return &ring;
+}
+
+/*
+  true if a block may be staged rather than written directly
+ */
+bool AP_Logger::staging_allowed(uint16_t size)
+{
+#if APM_BUILD_TYPE(APM_BUILD_Replay)
+    return false;
+#endif
+    if (!_io_thread_started || size > UINT8_MAX || _next_backend == 0) {
+        return false;
+    }
+    // until the startup messages are out writes must go direct so
+    // that the main thread can start logs and write its messages in
+    // order with the startup messages
+    for (uint8_t i=0; i<_next_backend; i++) {
+        if (!backends[i]->staging_ok()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AP_Logger::WriteBlock_backends(const void *pBuffer, uint16_t size)
+{
+    for (uint8_t i=0; i<_next_backend; i++) {
+        backends[i]->WriteBlock(pBuffer, size);
+    }
+}
+
+/*
+  write a non-critical block through the staging ring of the calling
+  thread. This never blocks; if the ring is full the block is dropped
+  and counted against the ring. Returns false if the block should be
+  written directly to the backends instead
+ */
+bool AP_Logger::stage_block(const void *pBuffer, uint16_t size)
+{
+    if (!staging_allowed(size)) {
+        // anything this thread staged earlier must reach the
+        // backends before the direct write
+        flush_staged_writes();
+        return false;
+    }
+    StagingRing *ring = staging_ring_for_thread(true);
+    if (ring == nullptr) {
+        return false;
+    }
+    ring->ring.write(pBuffer, size);
+    return true;
+}
+
+/*
+  flush the staging ring of the calling thread, if it has one. Called
+  before the thread writes to the backends directly so its messages
+  stay in order
+ */
+void AP_Logger::flush_staged_writes()
+{
+    StagingRing *ring = staging_ring_for_thread(false);
+    if (ring != nullptr) {
+        ring->ring.flush(FUNCTOR_BIND_MEMBER(&AP_Logger::WriteBlock_backends, void, const void *, uint16_t));
+    }
+}
+
+/*
+  merge the staging rings into the backends. This runs as an IO
+  process rather than in the logging IO thread so that a slow
+  storage write doesn't hold up the rings
+ */
+void AP_Logger::drain_staging_rings()
+{
+    const uint8_t n = _num_staging_rings;
+    for (uint8_t r=0; r<n; r++) {
+        _staging_rings[r].ring.flush(FUNCTOR_BIND_MEMBER(&AP_Logger::WriteBlock_backends, void, const void *, uint16_t));
+    }
+
+    const uint32_t now = AP_HAL::micros();
+    if (now - _last_staging_stats_us > 1000000U) {
+        _last_staging_stats_us = now;
+        Write_StagingStats();
+    }
+}
+
+// write per-thread staging statistics, called at 1Hz
+void AP_Logger::Write_StagingStats()
+{
+    const uint64_t now_us = AP_HAL::micros64();
+    const uint8_t n = _num_staging_rings;
+    for (uint8_t r=0; r<n; r++) {
+        const AP_Logger_StagingRing &ring = _staging_rings[r].ring;
+        const struct log_LoggerStaging pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_STAGING_MSG),
+            time_us   : now_us,
+            instance  : r,
+            staged    : ring.staged(),
+            dropped   : ring.dropped(),
+            max_used  : (uint16_t)MIN(ring.max_used(), UINT16_MAX),
+        };
+        WriteBlock_backends(&pkt, sizeof(pkt));
+    }
+}
+#endif // HAL_LOGGER_STAGING_ENABLED
+
 // only the first backend write need succeed for us to be successful
 bool AP_Logger::WriteBlock_first_succeed(const void *pBuffer, uint16_t size) 
 {
+    flush_staged_writes();
+
     if (_next_backend == 0) {
         return false;
     }
@@ -765,10 +914,12 @@ bool AP_Logger::WriteReplayBlock(uint8_t msg_id, const void *pBuffer, uint16_t s
 }
 
 void AP_Logger::WriteCriticalBlock(const void *pBuffer, uint16_t size) {
+    flush_staged_writes();
     FOR_EACH_BACKEND(WriteCriticalBlock(pBuffer, size));
 }
 
 void AP_Logger::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) {
+    flush_staged_writes();
     FOR_EACH_BACKEND(WritePrioritisedBlock(pBuffer, size, is_critical));
 }
 
@@ -867,27 +1018,32 @@ void AP_Logger::flush(void) {
 
 void AP_Logger::Write_EntireMission()
 {
+    flush_staged_writes();
     FOR_EACH_BACKEND(Write_EntireMission());
 }
 
 void AP_Logger::Write_Message(const char *message)
 {
+    flush_staged_writes();
     FOR_EACH_BACKEND(Write_Message(message));
 }
 
 void AP_Logger::Write_Mode(uint8_t mode, const ModeReason reason)
 {
+    flush_staged_writes();
     FOR_EACH_BACKEND(Write_Mode(mode, reason));
 }
 
 void AP_Logger::Write_Parameter(const char *name, float value)
 {
+    flush_staged_writes();
     FOR_EACH_BACKEND(Write_Parameter(name, value, quiet_nanf()));
 }
 
 void AP_Logger::Write_Mission_Cmd(const AP_Mission &mission,
                                             const AP_Mission::Mission_Command &cmd)
 {
+    flush_staged_writes();
     FOR_EACH_BACKEND(Write_Mission_Cmd(mission, cmd));
 }
 
@@ -896,11 +1052,13 @@ void AP_Logger::Write_RallyPoint(uint8_t total,
                                  uint8_t sequence,
                                  const RallyLocation &rally_point)
 {
+    flush_staged_writes();
     FOR_EACH_BACKEND(Write_RallyPoint(total, sequence, rally_point));
 }
 
 void AP_Logger::Write_Rally()
 {
+    flush_staged_writes();
     FOR_EACH_BACKEND(Write_Rally());
 }
 #endif
@@ -908,6 +1066,7 @@ void AP_Logger::Write_Rally()
 #if HAL_LOGGER_FENCE_ENABLED
 void AP_Logger::Write_Fence()
 {
+    flush_staged_writes();
     FOR_EACH_BACKEND(Write_Fence());
 }
 #endif
@@ -1020,6 +1179,7 @@ void AP_Logger::WriteV(const char *name, const char *labels, const char *units,
         return;
     }
 
+    flush_staged_writes();
     for (uint8_t i=0; i<_next_backend; i++) {
         if (!(f->sent_mask & (1U<<i))) {
             if (!backends[i]->Write_Emit_FMT(f->msg_type)) {
@@ -1103,10 +1263,31 @@ bool AP_Logger::assert_same_fmt_for_name(const AP_Logger::log_write_fmt *f,
 }
 #endif
 
+// index into _fmt_cache for a name and format string pointer pair
+uint8_t AP_Logger::fmt_cache_index(const char *name, const char *fmt)
+{
+    uintptr_t h = uintptr_t(name) ^ (uintptr_t(fmt) << 3);
+    h ^= h >> 5;
+    h ^= h >> 11;
+    return h & (HAL_LOGGER_FMT_CACHE_SIZE-1);
+}
+
 AP_Logger::log_write_fmt *AP_Logger::msg_fmt_for_name(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, const bool direct_comp, const bool copy_strings)
 {
     WITH_SEMAPHORE(log_write_fmts_sem);
     struct log_write_fmt *f;
+    fmt_cache_entry *cache = nullptr;
+    if (!direct_comp) {
+        cache = &_fmt_cache[fmt_cache_index(name, fmt)];
+        if (cache->name == name && cache->fmt == fmt) {
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+            if (!assert_same_fmt_for_name(cache->f, name, labels, units, mults, fmt)) {
+                return nullptr;
+            }
+#endif
+            return cache->f;
+        }
+    }
     for (f = log_write_fmts; f; f=f->next) {
         if (!direct_comp) {
             if (f->name == name) { // ptr comparison
@@ -1116,6 +1297,7 @@ AP_Logger::log_write_fmt *AP_Logger::msg_fmt_for_name(const char *name, const ch
                     return nullptr;
                 }
 #endif
+                *cache = fmt_cache_entry{name, fmt, f};
                 return f;
             }
         } else {
@@ -1199,6 +1381,10 @@ AP_Logger::log_write_fmt *AP_Logger::msg_fmt_for_name(const char *name, const ch
         list_end->next = f;
     }
 
+    if (cache != nullptr) {
+        *cache = fmt_cache_entry{name, fmt, f};
+    }
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     struct log_write_fmt_strings ls_strings = {};
     struct LogStructure ls = {
@@ -1454,6 +1640,9 @@ void AP_Logger::start_io_thread(void)
     if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Logger::io_thread, void), "log_io", HAL_LOGGING_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_IO, 1)) {
         AP_HAL::panic("Failed to start Logger IO thread");
     }
+#if HAL_LOGGER_STAGING_ENABLED
+    hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Logger::drain_staging_rings, void));
+#endif
 
     _io_thread_started = true;
     return;
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "AP_Logger_config.h"
+#include "AP_Logger_StagingRing.h"
 
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Common/AP_Common.h>
@@ -13,6 +14,7 @@
 #include <AP_Vehicle/ModeReason.h>
 
 #include <stdint.h>
+#include <atomic>
 
 #include "LoggerMessageWriter.h"
 
@@ -389,7 +391,8 @@ public:
         const char *mults;
     } *log_write_fmts;
 
-    // return (possibly allocating) a log_write_fmt for a name
+    // return (possibly allocating) a log_write_fmt for a name. Unless
+    // direct_comp is set, name and fmt must be pointers which don't change
     struct log_write_fmt *msg_fmt_for_name(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, const bool direct_comp = false, const bool copy_strings = false);
 
     // output a FMT message for each backend if not already done so
@@ -440,6 +443,20 @@ private:
     // return (possibly allocating) a log_write_fmt for a name
     const struct log_write_fmt *log_write_fmt_for_msg_type(uint8_t msg_type) const;
 
+    /*
+      direct mapped cache of msg_fmt_for_name() lookups keyed on the
+      caller's name and format string pointers, avoiding a walk of
+      log_write_fmts for each Write() call. Formats are never freed,
+      so entries can't go stale
+     */
+    struct fmt_cache_entry {
+        const char *name;
+        const char *fmt;
+        struct log_write_fmt *f;
+    } _fmt_cache[HAL_LOGGER_FMT_CACHE_SIZE];
+    static_assert((HAL_LOGGER_FMT_CACHE_SIZE & (HAL_LOGGER_FMT_CACHE_SIZE-1)) == 0, "HAL_LOGGER_FMT_CACHE_SIZE must be a power of 2");
+    static uint8_t fmt_cache_index(const char *name, const char *fmt);
+
     const struct LogStructure *structure_for_msg_type(uint8_t msg_type) const;
 
     // return a msg_type which is not currently in use (or -1 if none available)
@@ -498,6 +515,32 @@ private:
     void io_thread();
     bool check_crash_dump_save(void);
 
+#if HAL_LOGGER_STAGING_ENABLED
+    /*
+      per-thread staging rings, claimed on the first staged write
+      from a thread
+     */
+    struct StagingRing {
+        const void *owner;      // thread which writes to this ring
+        AP_Logger_StagingRing ring;
+    };
+    StagingRing _staging_rings[HAL_LOGGER_STAGING_MAX_THREADS];
+    std::atomic<uint8_t> _num_staging_rings{0};
+    bool _staging_alloc_failed;
+    HAL_Semaphore _staging_sem;
+    uint32_t _last_staging_stats_us;
+
+    StagingRing *staging_ring_for_thread(bool claim);
+    bool staging_allowed(uint16_t size);
+    bool stage_block(const void *pBuffer, uint16_t size);
+    void WriteBlock_backends(const void *pBuffer, uint16_t size);
+    void drain_staging_rings();
+    void Write_StagingStats();
+    void flush_staged_writes();
+#else
+    void flush_staged_writes() {}
+#endif
+
 #if HAL_LOGGER_FILE_CONTENTS_ENABLED
     // support for logging file content
     struct file_list {
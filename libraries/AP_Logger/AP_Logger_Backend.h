@@ -76,6 +76,12 @@ public:
 
     virtual bool logging_started(void) const = 0;
 
+    // true once the startup messages have been written, after which
+    // writes from any thread may go through the staging rings
+    bool staging_ok() {
+        return logging_started() && _startup_messagewriter->finished();
+    }
+
     virtual void Init() = 0;
 
     virtual uint32_t bufferspace_available() = 0;
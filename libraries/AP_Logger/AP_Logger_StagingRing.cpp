@@ -0,0 +1,83 @@
+#include "AP_Logger_StagingRing.h"
+
+#if HAL_LOGGING_ENABLED
+
+#include <AP_InternalError/AP_InternalError.h>
+#include <AP_Math/AP_Math.h>
+
+bool AP_Logger_StagingRing::init(uint32_t size)
+{
+    _buf = new ByteBuffer(size);
+    if (_buf == nullptr || _buf->get_size() == 0) {
+        delete _buf;
+        _buf = nullptr;
+        return false;
+    }
+    return true;
+}
+
+/*
+  copy a message into the ring, returns false if it does not fit
+ */
+bool AP_Logger_StagingRing::push(const void *pBuffer, uint16_t size)
+{
+    if (size > UINT8_MAX || _buf->space() < size+1U) {
+        return false;
+    }
+    ByteBuffer::IoVec vec[2];
+    const uint8_t n_vec = _buf->reserve(vec, size+1);
+    // copy the length byte and message into the (possibly wrapped) reservation
+    const uint8_t *src = (const uint8_t *)pBuffer;
+    uint32_t ofs = 0;
+    for (uint8_t i=0; i<n_vec; i++) {
+        uint8_t *dst = vec[i].data;
+        uint32_t dst_len = vec[i].len;
+        if (ofs == 0 && dst_len > 0) {
+            *dst++ = size;
+            dst_len--;
+            ofs++;
+        }
+        memcpy(dst, &src[ofs-1], dst_len);
+        ofs += dst_len;
+    }
+    _buf->commit(size+1);
+
+    _staged++;
+    const uint32_t used = _buf->available();
+    if (used > _max_used) {
+        _max_used = used;
+    }
+    return true;
+}
+
+bool AP_Logger_StagingRing::write(const void *pBuffer, uint16_t size)
+{
+    if (push(pBuffer, size)) {
+        return true;
+    }
+    // the drain hasn't kept up; dropping the message keeps the
+    // writer off the backend semaphore
+    _dropped++;
+    return false;
+}
+
+void AP_Logger_StagingRing::flush(writer_fn_t writer)
+{
+    WITH_SEMAPHORE(_consumer_sem);
+    uint32_t avail = _buf->available();
+    uint8_t msg[UINT8_MAX];
+    while (avail > 0) {
+        uint8_t len;
+        if (!_buf->read_byte(&len) || _buf->read(msg, len) != len) {
+            // can't happen as the producer commits whole messages;
+            // discard what we know about from the consumer side
+            INTERNAL_ERROR(AP_InternalError::error_t::logger_dequeue_failure);
+            _buf->advance(MIN(avail, _buf->available()));
+            break;
+        }
+        avail -= MIN(avail, len+1U);
+        writer(msg, len);
+    }
+}
+
+#endif // HAL_LOGGING_ENABLED
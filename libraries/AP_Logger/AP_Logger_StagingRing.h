@@ -0,0 +1,54 @@
+#pragma once
+
+#include "AP_Logger_config.h"
+
+#if HAL_LOGGING_ENABLED
+
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_HAL/Semaphores.h>
+#include <AP_HAL/utility/functor.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+/*
+  staging ring for the logger writes of one thread. Each message is
+  stored as a length byte followed by the message, committed in one
+  step so a consumer never sees a partial message.
+
+  Only the owning thread pushes, and it never waits: a message which
+  doesn't fit is dropped and counted. Messages are consumed either by
+  the periodic drain or by the owning thread itself before it writes
+  directly to the backends; consumers are serialised by the ring's
+  semaphore, so the messages of a thread always reach the backends in
+  the order they were written
+ */
+class AP_Logger_StagingRing {
+public:
+    FUNCTOR_TYPEDEF(writer_fn_t, void, const void *, uint16_t);
+
+    // allocate the ring, returns false on allocation failure
+    bool init(uint32_t size);
+
+    // write a message from the owning thread. The message is staged
+    // if it fits, otherwise it is dropped and false is returned
+    bool write(const void *pBuffer, uint16_t size);
+
+    // write the staged messages to writer. May be called from any
+    // thread; at most the messages present at the start of the call
+    // are written so a busy producer can't hold the caller
+    void flush(writer_fn_t writer);
+
+    uint32_t staged() const { return _staged; }
+    uint32_t dropped() const { return _dropped; }
+    uint32_t max_used() const { return _max_used; }
+
+private:
+    bool push(const void *pBuffer, uint16_t size);
+
+    ByteBuffer *_buf = nullptr;
+    HAL_Semaphore _consumer_sem;
+    uint32_t _staged = 0;       // messages staged
+    uint32_t _dropped = 0;      // messages dropped because the ring was full
+    uint32_t _max_used = 0;     // high water mark of the ring in bytes
+};
+
+#endif // HAL_LOGGING_ENABLED
@@ -34,6 +34,27 @@
 
 #endif
 
+// non-critical writes are staged in a lock-free ring per thread and
+// merged into the backends by an IO process. Needs up to
+// HAL_LOGGER_STAGING_MAX_THREADS*HAL_LOGGER_STAGING_BUFSIZE bytes, so
+// only on boards with the memory for it
+#ifndef HAL_LOGGER_STAGING_ENABLED
+#define HAL_LOGGER_STAGING_ENABLED HAL_LOGGING_ENABLED && (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
+#ifndef HAL_LOGGER_STAGING_MAX_THREADS
+#define HAL_LOGGER_STAGING_MAX_THREADS 8
+#endif
+
+#ifndef HAL_LOGGER_STAGING_BUFSIZE
+#define HAL_LOGGER_STAGING_BUFSIZE 2048
+#endif
+
+// number of entries in the msg_fmt_for_name() lookup cache, must be a power of 2
+#ifndef HAL_LOGGER_FMT_CACHE_SIZE
+#define HAL_LOGGER_FMT_CACHE_SIZE 32
+#endif
+
 #ifndef HAL_LOGGER_FILE_CONTENTS_ENABLED
 #define HAL_LOGGER_FILE_CONTENTS_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED
 #endif
@@ -306,6 +306,37 @@ struct PACKED log_MAV {
     uint8_t flags;
     uint16_t stream_slowdown_ms;
     uint16_t times_full;
+    uint32_t drain_bps;
+    uint32_t stream_budget_bps;
+};
+
+struct PACKED log_MAVR {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t instance;
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t chan;
+    uint8_t mavtype;
+    uint32_t rx_packets;
+    uint32_t rx_bytes;
+    uint32_t fwd_packets;
+    uint32_t fwd_bytes;
+    uint32_t routes_dropped;
+    uint32_t loop_drops;
+};
+
+struct PACKED log_MAVS {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t chan;
+    uint8_t bucket;
+    uint8_t msg_count;
+    uint16_t interval_ms;
+    uint16_t sent_interval_ms;
+    float requested_rate;
+    float achieved_rate;
+    uint16_t bytes_per_pass;
 };
 
 struct PACKED log_RSSI {
@@ -546,6 +577,15 @@ struct PACKED log_Rally {
     int16_t altitude;
 };
 
+struct PACKED log_LoggerStaging {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t instance;
+    uint32_t staged;
+    uint32_t dropped;
+    uint16_t max_used;
+};
+
 struct PACKED log_Performance {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -564,6 +604,22 @@ struct PACKED log_Performance {
     uint32_t extra_loop_us;
 };
 
+struct PACKED log_TaskHistogram {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t task_index;
+    uint16_t tick_count;
+    uint16_t p50_us;
+    uint16_t p90_us;
+    uint16_t p99_us;
+    uint16_t max_us;
+    uint16_t late_p50;
+    uint16_t late_p99;
+    uint16_t slip_count;
+    uint16_t overrun_count;
+    uint16_t long_loops;
+};
+
 struct PACKED log_SRTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -794,6 +850,14 @@ struct PACKED log_VER {
 // @Field: FMx: Maximum free space in write buffer in last time period
 // @Field: FAv: Average free space in write buffer in last time period
 
+// @LoggerMessage: LSTG
+// @Description: Per-thread logger staging ring statistics
+// @Field: TimeUS: Time since system startup
+// @Field: I: staging ring instance, assigned in order of the first write from each thread
+// @Field: N: Number of messages staged by the thread
+// @Field: Drop: Number of messages dropped because the thread's ring was full
+// @Field: Max: High water mark of the ring
+
 // @LoggerMessage: DSTL
 // @Description: Deepstall Landing data
 // @Field: TimeUS: Time since system startup
@@ -874,6 +938,35 @@ struct PACKED log_VER {
 // @FieldBitmaskEnum: flags: GCS_MAVLINK::Flags
 // @Field: ss: stream slowdown is the number of ms being added to each message to fit within bandwidth
 // @Field: tf: times buffer was full when a message was going to be sent
+// @Field: bw: estimated rate the link can drain, in bytes per second
+// @Field: sbw: bytes per second allocated to streamed messages
+
+// @LoggerMessage: MAVR
+// @Description: MAVLink routing table entry and counters
+// @Field: TimeUS: Time since system startup
+// @Field: I: route number
+// @Field: sys: system ID of the route
+// @Field: comp: component ID of the route
+// @Field: chan: mavlink channel the route was learned on
+// @Field: type: MAV_TYPE from the route's heartbeat
+// @Field: rxp: packets received from the route
+// @Field: rxb: bytes received from the route
+// @Field: fwp: packets forwarded to the route
+// @Field: fwb: bytes forwarded to the route
+// @Field: rd: routes not learned because the routing table was full
+// @Field: ld: packets not forwarded because they came back around a loop
+
+// @LoggerMessage: MAVS
+// @Description: GCS MAVLink stream rates, one message per stream interval bucket
+// @Field: TimeUS: Time since system startup
+// @Field: chan: mavlink channel number
+// @Field: B: bucket number
+// @Field: N: number of messages in the bucket
+// @Field: Int: requested interval
+// @Field: SInt: interval after fitting the streams to the link bandwidth
+// @Field: RR: requested rate
+// @Field: AR: achieved rate since the last MAVS message
+// @Field: BPP: bytes sent each time the bucket is sent
 
 // @LoggerMessage: MAVC
 // @Description: MAVLink command we have just executed
@@ -961,6 +1054,21 @@ struct PACKED log_VER {
 // @Field: I2CI: Number of i2c interrupts serviced
 // @Field: Ex: number of microseconds being added to each loop to address scheduler overruns
 
+// @LoggerMessage: TSKH
+// @Description: Scheduler per-task run time and lateness histogram summary over the last logging period, written for a few tasks at a time in turn when per-task perf info is enabled
+// @Field: TimeUS: Time since system startup
+// @Field: I: task index, in the order shown by @SYS/tasks.txt
+// @Field: N: number of times the task ran
+// @Field: P50: median task run time
+// @Field: P90: 90th percentile task run time
+// @Field: P99: 99th percentile task run time
+// @Field: Max: maximum task run time
+// @Field: L50: median number of ticks the task started after it was due
+// @Field: L99: 99th percentile number of ticks the task started after it was due
+// @Field: Slp: number of times the task slipped by at least a whole period
+// @Field: Ovr: number of times the task overran its time budget
+// @Field: Lng: number of long running loops in which this was the slowest task
+
 // @LoggerMessage: POWR
 // @Description: System power information
 // @Field: TimeUS: Time since system startup
@@ -1274,6 +1382,8 @@ LOG_STRUCTURE_FROM_CAMERA \
     LOG_STRUCTURE_FROM_PROXIMITY                                    \
     { LOG_PERFORMANCE_MSG, sizeof(log_Performance),                     \
       "PM",  "QHHHIIHHIIIIII", "TimeUS,LR,NLon,NL,MaxT,Mem,Load,ErrL,IntE,ErrC,SPIC,I2CC,I2CI,Ex", "sz---b%------s", "F----0A------F" }, \
+    { LOG_TASK_HISTOGRAM_MSG, sizeof(log_TaskHistogram),                \
+      "TSKH", "QBHHHHHHHHHH", "TimeUS,I,N,P50,P90,P99,Max,L50,L99,Slp,Ovr,Lng", "s--ssss-----", "F--FFFF-----" }, \
     { LOG_SRTL_MSG, sizeof(log_SRTL), \
       "SRTL", "QBHHBfff", "TimeUS,Active,NumPts,MaxPts,Action,N,E,D", "s----mmm", "F----000" }, \
 LOG_STRUCTURE_FROM_AVOIDANCE \
@@ -1311,10 +1421,16 @@ LOG_STRUCTURE_FROM_RPM \
 LOG_STRUCTURE_FROM_FENCE \
     { LOG_DF_FILE_STATS, sizeof(log_DSF), \
       "DSF", "QIHIIII", "TimeUS,Dp,Blk,Bytes,FMn,FMx,FAv", "s--b---", "F--0---" }, \
+    { LOG_STAGING_MSG, sizeof(log_LoggerStaging), \
+      "LSTG", "QBIIH", "TimeUS,I,N,Drop,Max", "s#--b", "F---0", true }, \
     { LOG_RALLY_MSG, sizeof(log_Rally), \
       "RALY", "QBBLLh", "TimeUS,Tot,Seq,Lat,Lng,Alt", "s--DUm", "F--GGB" },  \
     { LOG_MAV_MSG, sizeof(log_MAV),   \
-      "MAV", "QBHHHBHH",   "TimeUS,chan,txp,rxp,rxdp,flags,ss,tf", "s#----s-", "F-000-C-" },   \
+      "MAV", "QBHHHBHHII",   "TimeUS,chan,txp,rxp,rxdp,flags,ss,tf,bw,sbw", "s#----s---", "F-000-C---" },   \
+    { LOG_MAV_ROUTE_MSG, sizeof(log_MAVR),   \
+      "MAVR", "QBBBBBIIIIII",   "TimeUS,I,sys,comp,chan,type,rxp,rxb,fwp,fwb,rd,ld", "s#-----b-b--", "F------0-0--", true },   \
+    { LOG_MAV_STREAM_MSG, sizeof(log_MAVS),   \
+      "MAVS", "QBBBHHffH",   "TimeUS,chan,B,N,Int,SInt,RR,AR,BPP", "s---sszzb", "F---CC--0" },   \
 LOG_STRUCTURE_FROM_VISUALODOM \
     { LOG_OPTFLOW_MSG, sizeof(log_Optflow), \
       "OF",   "QBffff",   "TimeUS,Qual,flowX,flowY,bodyX,bodyY", "s-EEnn", "F-0000" , true }, \
@@ -1409,12 +1525,16 @@ enum LogMessages : uint8_t {
     LOG_IDS_FROM_BEACON,
     LOG_IDS_FROM_PROXIMITY,
     LOG_DF_FILE_STATS,
+    LOG_STAGING_MSG,
     LOG_SRTL_MSG,
     LOG_PERFORMANCE_MSG,
+    LOG_TASK_HISTOGRAM_MSG,
     LOG_OPTFLOW_MSG,
     LOG_EVENT_MSG,
     LOG_WHEELENCODER_MSG,
     LOG_MAV_MSG,
+    LOG_MAV_STREAM_MSG,
+    LOG_MAV_ROUTE_MSG,
     LOG_ERROR_MSG,
     LOG_ADSB_MSG,
     LOG_ARM_DISARM_MSG,
@@ -0,0 +1,67 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Logger/AP_Logger.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static AP_Int32 log_bitmask;
+static AP_Logger logger{log_bitmask};
+
+// a typical number of dynamic formats on a vehicle with scripting
+#define NUM_FORMATS 64
+
+static char names[NUM_FORMATS][5];
+static const char *labels = "TimeUS,Val";
+static const char *fmt = "Qf";
+
+static void setup_formats()
+{
+    static bool done;
+    if (done) {
+        return;
+    }
+    done = true;
+    for (uint8_t i=0; i<NUM_FORMATS; i++) {
+        hal.util->snprintf(names[i], sizeof(names[i]), "B%03u", unsigned(i));
+        logger.msg_fmt_for_name(names[i], labels, nullptr, nullptr, fmt);
+    }
+}
+
+// lookup of the last registered format by pointer, as used by Write()
+static void BM_MsgFmtForNameLast(benchmark::State& state)
+{
+    setup_formats();
+    while (state.KeepRunning()) {
+        auto *f = logger.msg_fmt_for_name(names[NUM_FORMATS-1], labels, nullptr, nullptr, fmt);
+        gbenchmark_escape(f);
+    }
+}
+
+// lookup cycling through all formats
+static void BM_MsgFmtForNameAll(benchmark::State& state)
+{
+    setup_formats();
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        auto *f = logger.msg_fmt_for_name(names[i], labels, nullptr, nullptr, fmt);
+        gbenchmark_escape(f);
+        i = (i + 1) % NUM_FORMATS;
+    }
+}
+
+// lookup by name, as used by scripting. This walks the list of
+// formats, which is what every lookup did before the cache
+static void BM_MsgFmtForNameDirectComp(benchmark::State& state)
+{
+    setup_formats();
+    while (state.KeepRunning()) {
+        auto *f = logger.msg_fmt_for_name(names[NUM_FORMATS-1], labels, nullptr, nullptr, fmt, true);
+        gbenchmark_escape(f);
+    }
+}
+
+BENCHMARK(BM_MsgFmtForNameLast);
+BENCHMARK(BM_MsgFmtForNameAll);
+BENCHMARK(BM_MsgFmtForNameDirectComp);
+
+BENCHMARK_MAIN();
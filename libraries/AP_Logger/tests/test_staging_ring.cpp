@@ -0,0 +1,114 @@
+#include <AP_gtest.h>
+#include <AP_Logger/AP_Logger_StagingRing.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  records the sequence numbers of the messages reaching the backends
+ */
+class TestWriter {
+public:
+    void write(const void *pBuffer, uint16_t size) {
+        const uint8_t *b = (const uint8_t *)pBuffer;
+        EXPECT_GE(size, 2);
+        // every byte of a test message is the low byte of its
+        // sequence number; byte 1 carries the high byte
+        for (uint16_t i=2; i<size; i++) {
+            EXPECT_EQ(b[i], b[0]);
+        }
+        seq[count++] = b[0] | (b[1]<<8);
+    }
+    AP_Logger_StagingRing::writer_fn_t fn() {
+        return FUNCTOR_BIND_MEMBER(&TestWriter::write, void, const void *, uint16_t);
+    }
+    uint16_t seq[512];
+    uint16_t count;
+};
+
+static void make_msg(uint8_t *msg, uint16_t size, uint16_t seq)
+{
+    memset(msg, seq & 0xFF, size);
+    msg[1] = seq >> 8;
+}
+
+// messages written while the ring has space are held until a flush
+TEST(StagingRing, StageAndFlush)
+{
+    AP_Logger_StagingRing ring;
+    ASSERT_TRUE(ring.init(256));
+    TestWriter w {};
+
+    uint8_t msg[20];
+    for (uint16_t s=0; s<10; s++) {
+        make_msg(msg, sizeof(msg), s);
+        EXPECT_TRUE(ring.write(msg, sizeof(msg)));
+    }
+    EXPECT_EQ(w.count, 0);
+    EXPECT_EQ(ring.staged(), 10U);
+    EXPECT_EQ(ring.dropped(), 0U);
+    EXPECT_EQ(ring.max_used(), 10U*(sizeof(msg)+1));
+
+    ring.flush(w.fn());
+    ASSERT_EQ(w.count, 10);
+    for (uint16_t s=0; s<10; s++) {
+        EXPECT_EQ(w.seq[s], s);
+    }
+}
+
+// a full ring drops new messages without calling the writer, and the
+// messages that were staged still arrive in order
+TEST(StagingRing, OverflowDrops)
+{
+    AP_Logger_StagingRing ring;
+    ASSERT_TRUE(ring.init(100));
+    TestWriter w {};
+
+    const uint16_t num_msgs = 300;
+    uint8_t msg[33];
+    for (uint16_t s=0; s<num_msgs; s++) {
+        make_msg(msg, sizeof(msg), s);
+        const uint16_t count_before = w.count;
+        ring.write(msg, sizeof(msg));
+        // the producer never writes to the backends itself
+        EXPECT_EQ(w.count, count_before);
+        if (s % 50 == 49) {
+            // occasional drain as the IO process would do
+            ring.flush(w.fn());
+        }
+    }
+    ring.flush(w.fn());
+
+    EXPECT_GT(ring.dropped(), 0U);
+    EXPECT_EQ(ring.staged() + ring.dropped(), num_msgs);
+    EXPECT_EQ(w.count, ring.staged());
+    EXPECT_LE(ring.max_used(), 100U);
+    for (uint16_t i=1; i<w.count; i++) {
+        EXPECT_GT(w.seq[i], w.seq[i-1]);
+    }
+}
+
+// messages too long to stage are dropped rather than written
+TEST(StagingRing, LongMessageDropped)
+{
+    AP_Logger_StagingRing ring;
+    ASSERT_TRUE(ring.init(1024));
+    TestWriter w {};
+
+    uint8_t msg[300];
+    make_msg(msg, 10, 0);
+    EXPECT_TRUE(ring.write(msg, 10));
+    make_msg(msg, sizeof(msg), 1);
+    EXPECT_FALSE(ring.write(msg, sizeof(msg)));
+    make_msg(msg, 10, 2);
+    EXPECT_TRUE(ring.write(msg, 10));
+    EXPECT_EQ(w.count, 0);
+    ring.flush(w.fn());
+
+    ASSERT_EQ(w.count, 2);
+    EXPECT_EQ(w.seq[0], 0);
+    EXPECT_EQ(w.seq[1], 2);
+    EXPECT_EQ(ring.staged(), 2U);
+    EXPECT_EQ(ring.dropped(), 1U);
+}
+
+AP_GTEST_MAIN()
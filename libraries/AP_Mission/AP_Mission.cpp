@@ -79,6 +79,9 @@ void AP_Mission::init()
         _cmd_total.set(0);
     }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    cmd_cache_invalidate_all();
+#endif
 
     // check_eeprom_version - checks version of missions stored in eeprom matches this library
     // command list will be cleared if they do not match
@@ -761,6 +764,12 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    if (cmd_cache_lookup(index, cmd)) {
+        return true;
+    }
+#endif
+
     // ensure all bytes of cmd are zeroed
     cmd = {};
 
@@ -816,10 +825,67 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
     // set command's index to it's position in eeprom
     cmd.index = index;
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    cmd_cache_insert(cmd);
+#endif
+
     // return success
     return true;
 }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+/// cmd_cache_lookup - fill in cmd from the cache
+///     returns true if the command was in the cache
+bool AP_Mission::cmd_cache_lookup(uint16_t index, Mission_Command& cmd) const
+{
+    for (auto &e : _cmd_cache) {
+        if (e.cmd.index == index) {
+            e.last_used = ++_cmd_cache_clock;
+            cmd = e.cmd;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// cmd_cache_insert - add a command to the cache, replacing the least
+///     recently used entry
+void AP_Mission::cmd_cache_insert(const Mission_Command& cmd) const
+{
+    cmd_cache_entry *oldest = &_cmd_cache[0];
+    for (auto &e : _cmd_cache) {
+        if (e.cmd.index == 0) {
+            oldest = &e;
+            break;
+        }
+        if (e.last_used - oldest->last_used > UINT32_MAX/2) {
+            // e was used before oldest, allowing for wrap
+            oldest = &e;
+        }
+    }
+    oldest->cmd = cmd;
+    oldest->last_used = ++_cmd_cache_clock;
+}
+
+/// cmd_cache_invalidate - remove a command from the cache
+void AP_Mission::cmd_cache_invalidate(uint16_t index)
+{
+    for (auto &e : _cmd_cache) {
+        if (e.cmd.index == index) {
+            e.cmd.index = 0;
+        }
+    }
+}
+
+/// cmd_cache_invalidate_all - empty the cache
+void AP_Mission::cmd_cache_invalidate_all()
+{
+    for (auto &e : _cmd_cache) {
+        e.cmd.index = 0;
+    }
+}
+#endif  // AP_MISSION_CMD_CACHE_SIZE
+
 bool AP_Mission::stored_in_location(uint16_t id)
 {
     switch (id) {
@@ -846,18 +912,9 @@ bool AP_Mission::stored_in_location(uint16_t id)
     }
 }
 
-/// write_cmd_to_storage - write a command to storage
-///     index is used to calculate the storage location
-///     true is returned if successful
-bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd)
+/// format_cmd_for_storage - format a command as it is held in storage
+void AP_Mission::format_cmd_for_storage(const Mission_Command& cmd, uint8_t buf[AP_MISSION_EEPROM_COMMAND_SIZE])
 {
-    WITH_SEMAPHORE(_rsem);
-
-    // range check cmd's index
-    if (index >= num_commands_max()) {
-        return false;
-    }
-
     PackedContent packed {};
     if (stored_in_location(cmd.id)) {
         // Location is not PACKED; field-wise copy it:
@@ -877,14 +934,11 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         memcpy(packed.bytes, &cmd.content, 12);
     }
 
-    // calculate where in storage the command should be placed
-    uint16_t pos_in_storage = 4 + (index * AP_MISSION_EEPROM_COMMAND_SIZE);
-
     if (cmd.id < 256) {
         // for commands below 256 we store up to 12 bytes
-        _storage.write_byte(pos_in_storage, cmd.id);
-        _storage.write_uint16(pos_in_storage+1, cmd.p1);
-        _storage.write_block(pos_in_storage+3, packed.bytes, 12);
+        buf[0] = cmd.id;
+        memcpy(&buf[1], &cmd.p1, 2);
+        memcpy(&buf[3], packed.bytes, 12);
     } else {
         // if the command ID is above 256 we store a tag byte followed
         // by the 16 bit command ID. The tag byte is 1 for commands
@@ -895,11 +949,35 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         if (cmd.id == MAV_CMD_NAV_SCRIPT_TIME) {
             tag_byte = 1;
         }
-        _storage.write_byte(pos_in_storage, tag_byte);
-        _storage.write_uint16(pos_in_storage+1, cmd.id);
-        _storage.write_uint16(pos_in_storage+3, cmd.p1);
-        _storage.write_block(pos_in_storage+5, packed.bytes, 10);
+        buf[0] = tag_byte;
+        memcpy(&buf[1], &cmd.id, 2);
+        memcpy(&buf[3], &cmd.p1, 2);
+        memcpy(&buf[5], packed.bytes, 10);
     }
+}
+
+/// write_cmd_to_storage - write a command to storage
+///     index is used to calculate the storage location
+///     true is returned if successful
+bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd)
+{
+    WITH_SEMAPHORE(_rsem);
+
+    // range check cmd's index
+    if (index >= num_commands_max()) {
+        return false;
+    }
+
+    uint8_t buf[AP_MISSION_EEPROM_COMMAND_SIZE];
+    format_cmd_for_storage(cmd, buf);
+
+    // calculate where in storage the command should be placed
+    uint16_t pos_in_storage = 4 + (index * AP_MISSION_EEPROM_COMMAND_SIZE);
+    _storage.write_block(pos_in_storage, buf, sizeof(buf));
+
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    cmd_cache_invalidate(index);
+#endif
 
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
@@ -918,6 +996,65 @@ void AP_Mission::write_home_to_storage()
     write_cmd_to_storage(0,home_cmd);
 }
 
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+/// staging_begin - start staging a replacement mission of count commands
+///     returns false if there is not enough memory
+bool AP_Mission::staging_begin(uint16_t count)
+{
+    staging_abort();
+    if (count == 0 || count > num_commands_max()) {
+        return false;
+    }
+    _staging = new uint8_t[count * AP_MISSION_EEPROM_COMMAND_SIZE];
+    if (_staging == nullptr) {
+        return false;
+    }
+    _staging_count = count;
+    return true;
+}
+
+/// staging_set_cmd - set command index of the staged mission
+bool AP_Mission::staging_set_cmd(uint16_t index, const Mission_Command& cmd)
+{
+    if (_staging == nullptr || index >= _staging_count) {
+        return false;
+    }
+    format_cmd_for_storage(cmd, &_staging[index * AP_MISSION_EEPROM_COMMAND_SIZE]);
+    return true;
+}
+
+/// staging_commit - replace the mission with the staged commands
+///     the commands are written in a single block and the command count
+///     saved once, holding the semaphore so that readers see either the
+///     old or the new mission. The writes to the storage device itself
+///     are made by the storage IO thread
+bool AP_Mission::staging_commit()
+{
+    if (_staging == nullptr) {
+        return false;
+    }
+    {
+        WITH_SEMAPHORE(_rsem);
+        _storage.write_block(4, _staging, _staging_count * AP_MISSION_EEPROM_COMMAND_SIZE);
+        _cmd_total.set_and_save(_staging_count);
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+        cmd_cache_invalidate_all();
+#endif
+        _last_change_time_ms = AP_HAL::millis();
+    }
+    staging_abort();
+    return true;
+}
+
+/// staging_abort - discard any staged mission
+void AP_Mission::staging_abort()
+{
+    delete[] _staging;
+    _staging = nullptr;
+    _staging_count = 0;
+}
+#endif  // AP_MISSION_STAGED_UPLOAD_ENABLED
+
 MAV_MISSION_RESULT AP_Mission::sanity_check_params(const mavlink_mission_item_int_t& packet)
 {
     uint8_t nan_mask;
@@ -34,6 +34,15 @@
 #endif
 #endif
 
+// number of commands decoded from storage which are kept for reuse
+#ifndef AP_MISSION_CMD_CACHE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MISSION_CMD_CACHE_SIZE 8
+#else
+#define AP_MISSION_CMD_CACHE_SIZE 0
+#endif
+#endif
+
 #define AP_MISSION_JUMP_REPEAT_FOREVER      -1      // when do-jump command's repeat count is -1 this means endless repeat
 
 #define AP_MISSION_CMD_ID_NONE              0       // mavlink cmd id of zero means invalid or missing command
@@ -618,6 +627,18 @@ public:
     ///     home is taken directly from ahrs
     void write_home_to_storage();
 
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    /// staged replacement of the whole mission. Commands are held in
+    /// RAM, in any order, until staging_commit() writes them all to
+    /// storage and makes them the current mission in one step
+    bool staging_begin(uint16_t count);
+    bool staging_set_cmd(uint16_t index, const Mission_Command& cmd);
+    bool staging_commit();
+    void staging_abort();
+    bool staging_active() const { return _staging != nullptr; }
+    uint16_t staging_count() const { return _staging_count; }
+#endif
+
     static MAV_MISSION_RESULT convert_MISSION_ITEM_to_MISSION_ITEM_INT(const mavlink_mission_item_t &mission_item,
             mavlink_mission_item_int_t &mission_item_int) WARN_IF_UNUSED;
     static MAV_MISSION_RESULT convert_MISSION_ITEM_INT_to_MISSION_ITEM(const mavlink_mission_item_int_t &mission_item_int,
@@ -739,6 +760,9 @@ private:
 
     static bool stored_in_location(uint16_t id);
 
+    // format a command as it is held in storage
+    static void format_cmd_for_storage(const Mission_Command& cmd, uint8_t buf[AP_MISSION_EEPROM_COMMAND_SIZE]);
+
     struct {
         uint16_t age;   // a value of 0 means we have never seen a tag. Once a tag is seen, age will increment every time the mission index changes.
         uint16_t tag;   // most recent tag that was successfully jumped to. Only valid if age > 0
@@ -868,9 +892,31 @@ private:
     bool _failed_sdcard_storage;
 #endif
 
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    // commands of a mission being staged, in storage format
+    uint8_t *_staging;
+    uint16_t _staging_count;
+#endif
+
     // fast call to get command ID of a mission index
     uint16_t get_command_id(uint16_t index) const;
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    // least recently used cache of commands decoded from storage, as
+    // the same commands are read many times when looking ahead. Home
+    // (index 0) is never cached, so an index of 0 marks an empty entry
+    struct cmd_cache_entry {
+        Mission_Command cmd;
+        uint32_t last_used;
+    };
+    mutable cmd_cache_entry _cmd_cache[AP_MISSION_CMD_CACHE_SIZE];
+    mutable uint32_t _cmd_cache_clock;
+    bool cmd_cache_lookup(uint16_t index, Mission_Command& cmd) const;
+    void cmd_cache_insert(const Mission_Command& cmd) const;
+    void cmd_cache_invalidate(uint16_t index);
+    void cmd_cache_invalidate_all();
+#endif
+
     // memoisation of contains-relative:
     bool _contains_terrain_alt_items;  // true if the mission has terrain-relative items
     uint32_t _last_contains_relative_calculated_ms;  // will be equal to _last_change_time_ms if _contains_terrain_alt_items is up-to-date
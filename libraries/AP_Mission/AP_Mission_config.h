@@ -3,3 +3,9 @@
 #ifndef AP_MISSION_ENABLED
 #define AP_MISSION_ENABLED 1
 #endif
+
+// missions uploaded by a GCS are held in RAM and replace the stored
+// mission in one step when the upload completes
+#ifndef AP_MISSION_STAGED_UPLOAD_ENABLED
+#define AP_MISSION_STAGED_UPLOAD_ENABLED AP_MISSION_ENABLED && HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#endif
@@ -55,6 +55,7 @@ private:
     void run_set_current_cmd_while_stopped_test();
     void run_replace_cmd_test();
     void run_max_cmd_test();
+    void run_lookahead_benchmark();
 
     AP_Mission mission{
             FUNCTOR_BIND_MEMBER(&MissionTest::start_cmd, bool, const AP_Mission::Mission_Command &),
@@ -157,6 +158,9 @@ void MissionTest::run_mission_test()
     // run_max_cmd_test - tests filling the eeprom with commands and then reading them back
     //run_max_cmd_test();
 
+    // run_lookahead_benchmark - times navigation lookahead over a large mission with do-jumps
+    //run_lookahead_benchmark();
+
     // print current mission
     print_mission();
 
@@ -1327,6 +1331,72 @@ void MissionTest::run_max_cmd_test()
     }
 }
 
+// run_lookahead_benchmark - times navigation lookahead over a mission
+//      of up to 1000 commands, with a do-jump back 10 commands after
+//      every 50th command and a do command after every 5th
+void MissionTest::run_lookahead_benchmark()
+{
+    AP_Mission::Mission_Command cmd {};
+    const uint16_t num_commands = MIN(1000U, (unsigned)mission.num_commands_max());
+    const uint8_t passes = 10;
+
+    mission.clear();
+
+    // Command #0 : home
+    cmd.id = MAV_CMD_NAV_WAYPOINT;
+    cmd.content.location = Location{
+        12345678,
+        23456789,
+        0,
+        Location::AltFrame::ABSOLUTE
+    };
+    mission.add_cmd(cmd);
+
+    while (mission.num_commands() < num_commands) {
+        const uint16_t index = mission.num_commands();
+        cmd = {};
+        if (index % 50 == 0 && index > 10) {
+            cmd.id = MAV_CMD_DO_JUMP;
+            cmd.content.jump.target = index - 10;
+            cmd.content.jump.num_times = 2;
+        } else if (index % 5 == 0) {
+            cmd.id = MAV_CMD_DO_CHANGE_SPEED;
+            cmd.content.speed.target_ms = 5;
+        } else {
+            cmd.id = MAV_CMD_NAV_WAYPOINT;
+            cmd.content.location = Location{
+                12345678 + index,
+                23456789 + index,
+                index,
+                Location::AltFrame::ABSOLUTE
+            };
+        }
+        if (!mission.add_cmd(cmd)) {
+            hal.console->printf("failed to add command #%u\n", (unsigned)index);
+            return;
+        }
+    }
+
+    // look ahead from each command in turn, as the mission does when
+    // advancing, along with the do commands after it
+    uint32_t lookups = 0;
+    const uint64_t start_us = AP_HAL::micros64();
+    for (uint8_t pass = 0; pass < passes; pass++) {
+        for (uint16_t i = 1; i < num_commands; i++) {
+            mission.get_next_nav_cmd(i, cmd);
+            mission.get_next_nav_cmd(i + 1, cmd);
+            lookups += 2;
+        }
+    }
+    const uint64_t dt_us = AP_HAL::micros64() - start_us;
+
+    hal.console->printf("lookahead over %u commands: %u lookups in %lu us, %.3f us per lookup\n",
+                        (unsigned)num_commands,
+                        (unsigned)lookups,
+                        (unsigned long)dt_us,
+                        double(dt_us) / lookups);
+}
+
 // setup
 void MissionTest::setup(void)
 {
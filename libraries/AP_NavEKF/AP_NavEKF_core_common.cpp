@@ -16,10 +16,11 @@
  */
 #include "AP_NavEKF_core_common.h"
 
-NavEKF_core_common::Matrix24 NavEKF_core_common::KH;
-NavEKF_core_common::Matrix24 NavEKF_core_common::KHP;
-NavEKF_core_common::Matrix24 NavEKF_core_common::nextP;
-NavEKF_core_common::Vector28 NavEKF_core_common::Kfusion;
+alignas(16) NavEKF_core_common::Matrix24 NavEKF_core_common::KH;
+alignas(16) NavEKF_core_common::Matrix24 NavEKF_core_common::KHP;
+alignas(16) NavEKF_core_common::Matrix24 NavEKF_core_common::nextP;
+alignas(16) NavEKF_core_common::Vector28 NavEKF_core_common::Kfusion;
+alignas(16) NavEKF_core_common::Vector28 NavEKF_core_common::HP;
 
 /*
   fill common scratch variables, for detecting re-use of variables between loops in SITL
@@ -35,5 +36,42 @@ void NavEKF_core_common::fill_scratch_variables(void)
     fill_nanf(&KHP[0][0], sizeof(KHP)/sizeof(ftype));
     fill_nanf(&nextP[0][0], sizeof(nextP)/sizeof(ftype));
     fill_nanf(&Kfusion[0], sizeof(Kfusion)/sizeof(ftype));
+    fill_nanf(&HP[0], sizeof(HP)/sizeof(ftype));
 #endif
 }
+
+/*
+  apply the covariance correction P = P - K*HP for a scalar observation
+  followed by forcing symmetry, as done by ForceSymmetry()
+
+  This avoids forming the KH and KHP matrices, which costs a multiply
+  and add per non-zero Jacobian element for every element of P. K*HP
+  is not symmetric when some gains are zeroed to inhibit states, so
+  the off-diagonal terms average K[i]*HP[j] and K[j]*HP[i]. The inner
+  loop runs along contiguous rows of P so that it can be vectorised by
+  the compiler
+ */
+bool NavEKF_core_common::covariance_update(Matrix24 &P, const ftype *K, const ftype *HP, uint8_t stateIndexLim)
+{
+    // Check that we are not going to drive any variances negative and skip the update if so
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        if (K[i] * HP[i] > P[i][i]) {
+            return false;
+        }
+    }
+
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        const ftype Ki = K[i];
+        const ftype HPi = HP[i];
+        ftype *Prow = &P[i][0];
+        Prow[i] -= Ki * HPi;
+        for (uint8_t j=i+1; j<=stateIndexLim; j++) {
+            Prow[j] -= 0.5f * (Ki * HP[j] + K[j] * HPi);
+        }
+        // copy to the lower triangle, which has not yet been used by later rows
+        for (uint8_t j=i+1; j<=stateIndexLim; j++) {
+            P[j][i] = Prow[j];
+        }
+    }
+    return true;
+}
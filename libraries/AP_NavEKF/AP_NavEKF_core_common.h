@@ -41,11 +41,23 @@ public:
     typedef ftype Matrix24[24][24];
 #endif
 
+    /*
+      apply the covariance correction P = P - K*HP for a scalar
+      observation, where HP is the observation Jacobian multiplied by
+      P, over states 0 to stateIndexLim. The result matches P -= K*HP
+      followed by ForceSymmetry(), including when gains have been
+      zeroed to inhibit states. Only the upper triangle is calculated
+      and is then mirrored. Returns false and leaves P unchanged if the correction would
+      drive a variance negative
+     */
+    static bool covariance_update(Matrix24 &P, const ftype *K, const ftype *HP, uint8_t stateIndexLim);
+
 protected:
-    static Matrix24 KH;                   // intermediate result used for covariance updates
-    static Matrix24 KHP;                  // intermediate result used for covariance updates
-    static Matrix24 nextP;                // Predicted covariance matrix before addition of process noise to diagonals
-    static Vector28 Kfusion;              // intermediate fusion vector
+    alignas(16) static Matrix24 KH;       // intermediate result used for covariance updates
+    alignas(16) static Matrix24 KHP;      // intermediate result used for covariance updates
+    alignas(16) static Matrix24 nextP;    // Predicted covariance matrix before addition of process noise to diagonals
+    alignas(16) static Vector28 Kfusion;  // intermediate fusion vector
+    alignas(16) static Vector28 HP;       // observation Jacobian multiplied by the covariance matrix
 
     // fill all the common scratch variables with NaN on SITL
     void fill_scratch_variables(void);
@@ -0,0 +1,127 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF/AP_NavEKF_core_common.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+typedef NavEKF_core_common::Matrix24 Matrix24;
+typedef NavEKF_core_common::Vector28 Vector28;
+
+static const uint8_t stateIndexLim = 23;
+
+// magnetometer fusion has non-zero Jacobian elements for the quaternion and magnetic field states
+static const uint8_t mag_H_index[] = { 0, 1, 2, 3, 16, 17, 18, 19, 20, 21 };
+
+// a diagonally dominant, and so positive definite, covariance matrix
+static void init_covariance(Matrix24 &P)
+{
+    for (uint8_t i=0; i<24; i++) {
+        for (uint8_t j=0; j<24; j++) {
+            P[i][j] = (i == j) ? 1.0f : 0.01f / (1 + i + j);
+        }
+    }
+}
+
+// observation of a single state, as used by FuseVelPosNED
+static void BM_CovarianceUpdateDirect(benchmark::State& state)
+{
+    Matrix24 P;
+    Vector28 K, HP;
+    const uint8_t stateIndex = 7;
+
+    while (state.KeepRunning()) {
+        init_covariance(P);
+        for (uint8_t i=0; i<=stateIndexLim; i++) {
+            K[i] = P[i][stateIndex] * 0.1f;
+        }
+        for (uint8_t j=0; j<=stateIndexLim; j++) {
+            HP[j] = P[stateIndex][j];
+        }
+        bool ret = NavEKF_core_common::covariance_update(P, &K[0], &HP[0], stateIndexLim);
+        gbenchmark_escape(&ret);
+        gbenchmark_escape(&P);
+    }
+}
+
+// observation of one magnetometer axis, as used by FuseMagnetometer
+static void BM_CovarianceUpdateMag(benchmark::State& state)
+{
+    Matrix24 P;
+    Vector28 K, HP;
+
+    while (state.KeepRunning()) {
+        init_covariance(P);
+        for (uint8_t i=0; i<=stateIndexLim; i++) {
+            K[i] = 0.001f * i;
+        }
+        for (uint8_t j=0; j<=stateIndexLim; j++) {
+            ftype res = 0;
+            for (uint8_t k : mag_H_index) {
+                res += 0.5f * P[k][j];
+            }
+            HP[j] = res;
+        }
+        bool ret = NavEKF_core_common::covariance_update(P, &K[0], &HP[0], stateIndexLim);
+        gbenchmark_escape(&ret);
+        gbenchmark_escape(&P);
+    }
+}
+
+// the previous implementation of FuseMagnetometer, forming KH and KHP explicitly, for comparison
+static void BM_CovarianceUpdateMagKHP(benchmark::State& state)
+{
+    Matrix24 P, KH, KHP;
+    Vector28 K;
+
+    while (state.KeepRunning()) {
+        init_covariance(P);
+        for (uint8_t i=0; i<=stateIndexLim; i++) {
+            K[i] = 0.001f * i;
+        }
+        for (uint8_t i=0; i<=stateIndexLim; i++) {
+            for (uint8_t j=0; j<=stateIndexLim; j++) {
+                KH[i][j] = 0.0f;
+            }
+            for (uint8_t k : mag_H_index) {
+                KH[i][k] = K[i] * 0.5f;
+            }
+        }
+        for (uint8_t j=0; j<=stateIndexLim; j++) {
+            for (uint8_t i=0; i<=stateIndexLim; i++) {
+                ftype res = 0;
+                for (uint8_t k : mag_H_index) {
+                    res += KH[i][k] * P[k][j];
+                }
+                KHP[i][j] = res;
+            }
+        }
+        bool healthyFusion = true;
+        for (uint8_t i=0; i<=stateIndexLim; i++) {
+            if (KHP[i][i] > P[i][i]) {
+                healthyFusion = false;
+            }
+        }
+        if (healthyFusion) {
+            for (uint8_t i=0; i<=stateIndexLim; i++) {
+                for (uint8_t j=0; j<=stateIndexLim; j++) {
+                    P[i][j] = P[i][j] - KHP[i][j];
+                }
+            }
+            for (uint8_t i=1; i<=stateIndexLim; i++) {
+                for (uint8_t j=0; j<=i-1; j++) {
+                    const ftype temp = 0.5f*(P[i][j] + P[j][i]);
+                    P[i][j] = temp;
+                    P[j][i] = temp;
+                }
+            }
+        }
+        gbenchmark_escape(&healthyFusion);
+        gbenchmark_escape(&P);
+    }
+}
+
+BENCHMARK(BM_CovarianceUpdateDirect);
+BENCHMARK(BM_CovarianceUpdateMag);
+BENCHMARK(BM_CovarianceUpdateMagKHP);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+#include <AP_gtest.h>
+
+/*
+  tests for NavEKF_core_common::covariance_update()
+ */
+
+#include <AP_NavEKF/AP_NavEKF_core_common.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+typedef NavEKF_core_common::Matrix24 Matrix24;
+typedef NavEKF_core_common::Vector28 Vector28;
+
+static const uint8_t stateIndexLim = 23;
+
+// a diagonally dominant, and so positive definite, covariance matrix
+static void init_covariance(Matrix24 &P)
+{
+    for (uint8_t i=0; i<24; i++) {
+        for (uint8_t j=0; j<24; j++) {
+            P[i][j] = (i == j) ? 1.0f : 0.01f * (1 + ((i + j) % 7)) / (1 + i + j);
+        }
+    }
+}
+
+// the update as done before covariance_update(): P -= K*HP then ForceSymmetry()
+static void reference_update(Matrix24 &P, const Vector28 &K, const Vector28 &HP)
+{
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        for (uint8_t j=0; j<=stateIndexLim; j++) {
+            P[i][j] = P[i][j] - K[i] * HP[j];
+        }
+    }
+    for (uint8_t i=1; i<=stateIndexLim; i++) {
+        for (uint8_t j=0; j<=i-1; j++) {
+            const ftype temp = 0.5f*(P[i][j] + P[j][i]);
+            P[i][j] = temp;
+            P[j][i] = temp;
+        }
+    }
+}
+
+// observe position state 7 as FuseVelPosNED does, optionally
+// inhibiting the delta velocity bias gains while the states stay active
+static void check_direct_observation(bool inhibit_dvel_bias)
+{
+    Matrix24 P, Pref;
+    Vector28 K, HP;
+    init_covariance(P);
+    init_covariance(Pref);
+
+    const uint8_t stateIndex = 7;
+    const ftype SK = 1.0f / (P[stateIndex][stateIndex] + 0.25f);
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        K[i] = P[i][stateIndex] * SK;
+        HP[i] = P[stateIndex][i];
+    }
+    if (inhibit_dvel_bias) {
+        K[13] = K[14] = K[15] = 0;
+    }
+
+    EXPECT_TRUE(NavEKF_core_common::covariance_update(P, &K[0], &HP[0], stateIndexLim));
+    reference_update(Pref, K, HP);
+
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        for (uint8_t j=0; j<=stateIndexLim; j++) {
+            EXPECT_NEAR(P[i][j], Pref[i][j], 1.0e-6) << "i=" << int(i) << " j=" << int(j);
+            EXPECT_EQ(P[i][j], P[j][i]);
+        }
+    }
+}
+
+TEST(NavEKF_core_common, CovarianceUpdate)
+{
+    check_direct_observation(false);
+}
+
+TEST(NavEKF_core_common, CovarianceUpdateInhibitedGains)
+{
+    check_direct_observation(true);
+}
+
+TEST(NavEKF_core_common, CovarianceUpdateNegativeVariance)
+{
+    Matrix24 P, P0;
+    Vector28 K, HP;
+    init_covariance(P);
+    init_covariance(P0);
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        K[i] = 0;
+        HP[i] = 0;
+    }
+    K[3] = 2.0f;
+    HP[3] = 1.0f;
+
+    EXPECT_FALSE(NavEKF_core_common::covariance_update(P, &K[0], &HP[0], stateIndexLim));
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        for (uint8_t j=0; j<=stateIndexLim; j++) {
+            EXPECT_EQ(P[i][j], P0[i][j]);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
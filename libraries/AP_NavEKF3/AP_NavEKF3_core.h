@@ -455,6 +455,9 @@ public:
     const EKFGSF_yaw *get_yawEstimator(void) const { return yawEstimator; }
 
 private:
+    // drives single fusion steps in libraries/AP_NavEKF3/benchmarks
+    friend class NavEKF3_core_benchmark;
+
     EKFGSF_yaw *yawEstimator;
     AP_DAL &dal;
 
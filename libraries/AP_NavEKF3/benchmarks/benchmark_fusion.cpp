@@ -0,0 +1,128 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_NavEKF3/AP_NavEKF3_core.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  runs complete EKF3 fusion steps, including the innovation checks,
+  Kalman gains, covariance correction and state update, on a core set
+  up in a steady state close to its measurements. The covariance and
+  states are restored before each step so every iteration does the
+  same work
+ */
+class NavEKF3_core_benchmark {
+public:
+    NavEKF3_core_benchmark() : core(&frontend) {}
+
+    void init();
+    void reset();
+    void fuse_mag();
+    void fuse_vel_pos();
+
+private:
+    NavEKF3 frontend;
+    NavEKF3_core core;
+
+    NavEKF3_core::Matrix24 P0;
+    NavEKF3_core::Vector24 states0;
+};
+
+void NavEKF3_core_benchmark::init()
+{
+    core.stateIndexLim = 23;
+    core.stateStruct.quat.from_euler(0.1f, -0.05f, 1.0f);
+    core.stateStruct.velocity = Vector3F(5.0f, -2.0f, 0.5f);
+    core.stateStruct.position = Vector3F(100.0f, 50.0f, -20.0f);
+    core.stateStruct.earth_magfield = Vector3F(0.2f, 0.05f, 0.4f);
+    core.gpsNoiseScaler = 1.0f;
+    core.posDownObsNoise = sq(0.5f);
+
+    // a diagonally dominant, and so positive definite, covariance matrix
+    for (uint8_t i=0; i<24; i++) {
+        for (uint8_t j=0; j<24; j++) {
+            core.P[i][j] = (i == j) ? 0.1f : 0.001f / (1 + i + j);
+        }
+    }
+
+    // a magnetometer reading close to the predicted field
+    Matrix3F Tbn;
+    core.stateStruct.quat.rotation_matrix(Tbn);
+    core.magDataDelayed.mag = Tbn.mul_transpose(core.stateStruct.earth_magfield) + Vector3F(0.002f, -0.001f, 0.001f);
+    core.imuDataDelayed.delAngDT = 0.0025f;
+
+    // GPS velocity and position and baro height close to the states
+    core.PV_AidingMode = NavEKF3_core::AID_ABSOLUTE;
+    core.activeHgtSource = AP_NavEKF_Source::SourceZ::BARO;
+    core.useGpsVertVel = true;
+    core.gpsDataDelayed.have_vz = true;
+    for (uint8_t i=0; i<3; i++) {
+        core.velPosObs[i] = core.stateStruct.velocity[i] + 0.1f;
+        core.velPosObs[i+3] = core.stateStruct.position[i] - 0.2f;
+    }
+
+    memcpy(&P0, &core.P, sizeof(P0));
+    memcpy(&states0, &core.statesArray, sizeof(states0));
+}
+
+void NavEKF3_core_benchmark::reset()
+{
+    memcpy(&core.P, &P0, sizeof(P0));
+    memcpy(&core.statesArray, &states0, sizeof(states0));
+}
+
+// fuse all three magnetometer axes
+void NavEKF3_core_benchmark::fuse_mag()
+{
+    core.FuseMagnetometer();
+    gbenchmark_escape(&core.P);
+    gbenchmark_escape(&core.statesArray);
+}
+
+// fuse GPS velocity and horizontal position and baro height
+void NavEKF3_core_benchmark::fuse_vel_pos()
+{
+    core.fuseVelData = true;
+    core.fusePosData = true;
+    core.fuseHgtData = true;
+    core.FuseVelPosNED();
+    gbenchmark_escape(&core.P);
+    gbenchmark_escape(&core.statesArray);
+}
+
+static NavEKF3_core_benchmark bm;
+
+static void BM_FuseMagnetometer(benchmark::State& state)
+{
+    bm.init();
+    while (state.KeepRunning()) {
+        bm.reset();
+        bm.fuse_mag();
+    }
+}
+
+static void BM_FuseVelPosNED(benchmark::State& state)
+{
+    bm.init();
+    while (state.KeepRunning()) {
+        bm.reset();
+        bm.fuse_vel_pos();
+    }
+}
+
+// the cost of restoring the covariance and states, to subtract from the above
+static void BM_FusionReset(benchmark::State& state)
+{
+    bm.init();
+    while (state.KeepRunning()) {
+        bm.reset();
+        gbenchmark_escape(&bm);
+    }
+}
+
+BENCHMARK(BM_FuseMagnetometer);
+BENCHMARK(BM_FuseVelPosNED);
+BENCHMARK(BM_FusionReset);
+
+BENCHMARK_MAIN();
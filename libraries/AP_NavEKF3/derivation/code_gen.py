@@ -41,5 +41,35 @@ class CodeGenerator:
         write_string = write_string + "\n\n"
         self.file.write(write_string)
 
+    def write_covariance_prediction(self, matrix, variable_name, state_blocks):
+        # write the upper triangle of the predicted covariance matrix one block of states at a time
+        # state_blocks is a list of (first, last, inhibit_flag) tuples. Each block after the first is
+        # nested inside a stateIndexLim check so it is only computed when those states are in use.
+        # If inhibit_flag is given, the block is zeroed instead of computed while that flag is true.
+        write_string = ""
+        indent = ""
+        for (first, last, inhibit_flag) in state_blocks:
+            if first > 0:
+                write_string = write_string + "\n" + indent + "if (stateIndexLim > " + str(first - 1) + ") {\n"
+                indent = indent + "    "
+            body_indent = indent
+            if inhibit_flag is not None:
+                write_string = write_string + indent + "if (" + inhibit_flag + ") {\n"
+                write_string = write_string + indent + "    zeroCols(" + variable_name + "," + str(first) + "," + str(last) + ");\n"
+                write_string = write_string + indent + "} else {\n"
+                body_indent = indent + "    "
+            for j in range(first, last + 1):
+                for i in range(0, j + 1):
+                    write_string = write_string + body_indent + variable_name + "[" + str(i) + "][" + str(j) + "] = " + self.get_ccode(matrix[i,j]) + ";\n"
+            if inhibit_flag is not None:
+                write_string = write_string + indent + "}\n"
+
+        while len(indent) > 0:
+            indent = indent[4:]
+            write_string = write_string + indent + "}\n"
+
+        write_string = write_string + "\n\n"
+        self.file.write(write_string)
+
     def close(self):
         self.file.close()
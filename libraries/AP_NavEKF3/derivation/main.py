@@ -666,7 +666,14 @@ def generate_code():
     cov_code_generator = CodeGenerator("./generated/covariance_generated.cpp")
     cov_code_generator.print_string("Equations for covariance matrix prediction, without process noise!")
     cov_code_generator.write_subexpressions(P_new_simple[0])
-    cov_code_generator.write_matrix(Matrix(P_new_simple[1]), "nextP", True, "[", "]")
+    # group the columns by state so that the covariance prediction cost scales with the number of active
+    # states. Inhibited magnetic field states are zeroed by ConstrainVariances() so don't need propagating.
+    state_blocks = [(0, 9, None),          # quaternion, velocity and position
+                    (10, 12, None),        # delta angle bias
+                    (13, 15, None),        # delta velocity bias
+                    (16, 21, "inhibitMagStates"), # earth and body magnetic field
+                    (22, 23, None)]        # wind velocity
+    cov_code_generator.write_covariance_prediction(Matrix(P_new_simple[1]), "nextP", state_blocks)
 
     cov_code_generator.close()
 
@@ -25,6 +25,7 @@
 
 #include <cmath>
 #include <string.h>
+#include <ctype.h>
 
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
@@ -91,6 +92,14 @@ uint16_t AP_Param::_count_marker;
 uint16_t AP_Param::_count_marker_done;
 HAL_Semaphore AP_Param::_count_sem;
 
+#if AP_PARAM_NAME_INDEX_ENABLED
+AP_Param::NameIndexEntry *AP_Param::_name_index;
+uint16_t AP_Param::_name_index_size;
+uint16_t AP_Param::_name_index_marker;
+uint16_t AP_Param::_name_index_num_vars;
+HAL_Semaphore AP_Param::_name_index_sem;
+#endif
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
@@ -876,84 +885,288 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 }
 
 
+// Find a variable by name within the top level variable vindex
+//
+AP_Param *
+AP_Param::find_in_var(const char *name, uint16_t vindex, enum ap_var_type *ptype, uint16_t *flags)
+{
+    const auto &info = var_info(vindex);
+    uint8_t type = info.type;
+    if (type == AP_PARAM_GROUP) {
+        uint8_t len = strnlen(info.name, AP_MAX_NAME_SIZE);
+        if (strncmp(name, info.name, len) != 0) {
+            return nullptr;
+        }
+        const struct GroupInfo *group_info = get_group_info(info);
+        if (group_info == nullptr) {
+            return nullptr;
+        }
+        AP_Param *ap = find_group(name + len, vindex, 0, group_info, ptype);
+        if (ap != nullptr && flags != nullptr) {
+            uint32_t group_element = 0;
+            const struct GroupInfo *ginfo;
+            struct GroupNesting group_nesting {};
+            uint8_t idx;
+            ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
+            if (ginfo != nullptr) {
+                *flags = ginfo->flags;
+            }
+        }
+        return ap;
+    }
+    if (strcasecmp(name, info.name) == 0) {
+        *ptype = (enum ap_var_type)type;
+        ptrdiff_t base;
+        if (!get_base(info, base)) {
+            return nullptr;
+        }
+        return (AP_Param *)base;
+    }
+    return nullptr;
+}
+
 // Find a variable by name.
 //
 AP_Param *
 AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
 {
+#if AP_PARAM_NAME_INDEX_ENABLED
+    // a miss, or an index busy in another thread, falls through to
+    // the linear search
+    AP_Param *ap = find_indexed(name, ptype, flags);
+    if (ap != nullptr) {
+        return ap;
+    }
+#endif
     for (uint16_t i=0; i<_num_vars; i++) {
-        const auto &info = var_info(i);
-        uint8_t type = info.type;
-        if (type == AP_PARAM_GROUP) {
-            uint8_t len = strnlen(info.name, AP_MAX_NAME_SIZE);
-            if (strncmp(name, info.name, len) != 0) {
-                continue;
-            }
-            const struct GroupInfo *group_info = get_group_info(info);
-            if (group_info == nullptr) {
-                continue;
+        // we continue looking after a group prefix matches as we
+        // want to allow top level parameter to have the same prefix
+        // name as group parameters, for example CAM_P_G
+        AP_Param *ret = find_in_var(name, i, ptype, flags);
+        if (ret != nullptr) {
+            return ret;
+        }
+    }
+    return nullptr;
+}
+
+#if AP_PARAM_NAME_INDEX_ENABLED
+// case insensitive FNV-1a hash of a parameter name
+uint32_t AP_Param::name_hash(const char *name)
+{
+    uint32_t h = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i] != 0; i++) {
+        h ^= uint8_t(toupper(name[i]));
+        h *= 16777619U;
+    }
+    return h;
+}
+
+// true if the index matches the current parameter tree
+bool AP_Param::name_index_valid()
+{
+    return _name_index != nullptr &&
+        _name_index_marker == _count_marker &&
+        _name_index_num_vars == _num_vars;
+}
+
+/*
+  (re)build the name index from the scalar parameters currently
+  visible. Must be called with _name_index_sem held
+ */
+void AP_Param::build_name_index()
+{
+    const uint16_t marker = _count_marker;
+    const uint16_t count = count_parameters();
+    if (count == 0) {
+        return;
+    }
+
+    // keep the load factor below 0.75
+    uint32_t size = 1;
+    while (size < count * 4U / 3U + 1) {
+        size <<= 1;
+    }
+    if (size > 0x8000) {
+        return;
+    }
+    if (size != _name_index_size) {
+        delete[] _name_index;
+        _name_index_size = 0;
+        _name_index = new NameIndexEntry[size];
+        if (_name_index == nullptr) {
+            return;
+        }
+        _name_index_size = size;
+    }
+    memset(_name_index, 0xFF, size * sizeof(NameIndexEntry));
+
+    ParamToken token {};
+    char name[AP_MAX_NAME_SIZE+1];
+    for (AP_Param *ap = first(&token, nullptr);
+         ap != nullptr;
+         ap = next_scalar(&token, nullptr)) {
+        ap->copy_name_token(token, name, AP_MAX_NAME_SIZE);
+        name[AP_MAX_NAME_SIZE] = 0;
+        const uint32_t h = name_hash(name);
+        uint16_t slot = h & (size-1);
+        uint16_t probes = 0;
+        while (_name_index[slot].vindex != 0xFFFF) {
+            if (++probes == size) {
+                // more parameters than when counted, try again later
+                return;
             }
-            AP_Param *ap = find_group(name + len, i, 0, group_info, ptype);
-            if (ap != nullptr) {
-                if (flags != nullptr) {
-                    uint32_t group_element = 0;
-                    const struct GroupInfo *ginfo;
-                    struct GroupNesting group_nesting {};
-                    uint8_t idx;
-                    ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
-                    if (ginfo != nullptr) {
-                        *flags = ginfo->flags;
-                    }
-                }
+            slot = (slot + 1) & (size-1);
+        }
+        _name_index[slot].hash = h >> 16;
+        _name_index[slot].vindex = token.key;
+        _name_index[slot].token = token;
+    }
+
+    _name_index_marker = marker;
+    _name_index_num_vars = _num_vars;
+}
+
+/*
+  find a variable using the name index. The index is only built
+  during startup or from threads other than the main thread, as
+  building it walks the whole parameter tree. If token is not null
+  the hit must also be a scalar, and token is set to its position
+  for next_scalar()
+
+  Returns nullptr without waiting if another thread holds the index,
+  for example while scripting or FTP rebuilds it, so the caller falls
+  back to the full search rather than stalling the main loop
+ */
+AP_Param *AP_Param::find_indexed(const char *name, enum ap_var_type *ptype, uint16_t *flags, ParamToken *token)
+{
+    if (!_name_index_sem.take_nonblocking()) {
+        return nullptr;
+    }
+    AP_Param *ap = find_indexed_locked(name, ptype, flags, token);
+    _name_index_sem.give();
+    return ap;
+}
+
+AP_Param *AP_Param::find_indexed_locked(const char *name, enum ap_var_type *ptype, uint16_t *flags, ParamToken *token)
+{
+    if (!name_index_valid()) {
+        if (hal.scheduler->in_main_thread() && hal.scheduler->is_system_initialized()) {
+            return nullptr;
+        }
+        build_name_index();
+        if (!name_index_valid()) {
+            return nullptr;
+        }
+    }
+    const uint32_t h = name_hash(name);
+    const uint16_t hash16 = h >> 16;
+    const uint16_t mask = _name_index_size - 1;
+    uint16_t slot = h & mask;
+    for (uint16_t probes=0; probes<_name_index_size; probes++) {
+        const NameIndexEntry &e = _name_index[slot];
+        if (e.vindex == 0xFFFF) {
+            break;
+        }
+        if (e.hash == hash16 && e.vindex < _num_vars) {
+            AP_Param *ap = find_in_var(name, e.vindex, ptype, flags);
+            if (ap != nullptr && token == nullptr) {
                 return ap;
             }
-            // we continue looking as we want to allow top level
-            // parameter to have the same prefix name as group
-            // parameters, for example CAM_P_G
-        } else if (strcasecmp(name, info.name) == 0) {
-            *ptype = (enum ap_var_type)type;
-            ptrdiff_t base;
-            if (!get_base(info, base)) {
-                return nullptr;
+            if (ap != nullptr && *ptype <= AP_PARAM_FLOAT) {
+                // another name in the same variable may share the
+                // hash, so check this slot's token names the match
+                char tname[AP_MAX_NAME_SIZE+1];
+                ap->copy_name_token(e.token, tname, AP_MAX_NAME_SIZE);
+                tname[AP_MAX_NAME_SIZE] = 0;
+                if (strncasecmp(tname, name, AP_MAX_NAME_SIZE) == 0) {
+                    *token = e.token;
+                    return ap;
+                }
             }
-            return (AP_Param *)base;
         }
+        slot = (slot + 1) & mask;
     }
     return nullptr;
 }
+#endif // AP_PARAM_NAME_INDEX_ENABLED
+
+// move the cursor to the parameter with index idx
+AP_Param *AP_Param::ParamCursor::seek(uint16_t idx, enum ap_var_type *ptype)
+{
+    float *default_val = _with_defaults ? &_default_val : nullptr;
+    if (_ap == nullptr || idx < _index || _marker != _count_marker) {
+        _marker = _count_marker;
+        _index = 0;
+        _ap = AP_Param::first(&_token, &_type, default_val);
+    }
+    while (_ap != nullptr && _index < idx) {
+        _ap = AP_Param::next_scalar(&_token, &_type, default_val);
+        _index++;
+    }
+    if (_ap != nullptr && ptype != nullptr) {
+        *ptype = _type;
+    }
+    return _ap;
+}
+
+// move the cursor to the next parameter
+AP_Param *AP_Param::ParamCursor::next(enum ap_var_type *ptype)
+{
+    if (_ap == nullptr) {
+        return nullptr;
+    }
+    return seek(_index+1, ptype);
+}
+
+// cursor shared by find_by_index() callers
+static AP_Param::ParamCursor index_cursor;
+static HAL_Semaphore index_cursor_sem;
 
-// Find a variable by index. Note that this is quite slow.
+// Find a variable by index. Ascending lookups continue from the
+// previous one, otherwise this walks from the first parameter
 //
 AP_Param *
 AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token)
 {
-    AP_Param *ap;
-    uint16_t count=0;
-    for (ap=AP_Param::first(token, ptype);
-         ap && count < idx;
-         ap=AP_Param::next_scalar(token, ptype)) {
-        count++;
-    }
-    return ap;    
+    WITH_SEMAPHORE(index_cursor_sem);
+    AP_Param *ap = index_cursor.seek(idx, ptype);
+    *token = index_cursor.token();
+    return ap;
 }
 
 // by-name equivalent of find_by_index()
 AP_Param* AP_Param::find_by_name(const char* name, enum ap_var_type *ptype, ParamToken *token)
 {
+    // the top level match in find() is case sensitive, so upper case
+    // the name
+    char uname[AP_MAX_NAME_SIZE+1] {};
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i] != 0; i++) {
+        uname[i] = toupper(name[i]);
+    }
+    enum ap_var_type type;
     AP_Param *ap;
-    uint16_t count = 0;
+#if AP_PARAM_NAME_INDEX_ENABLED
+    // the index holds the token of each name, so a hit needs no walk
+    ap = find_indexed(uname, &type, nullptr, token);
+    if (ap != nullptr) {
+        *ptype = type;
+        return ap;
+    }
+#endif
+    // otherwise find the variable, which is cheap, and then walk the
+    // parameters comparing pointers to fill in the token
+    const AP_Param *target = find(uname, &type);
+    if (target == nullptr || type > AP_PARAM_FLOAT) {
+        // only scalars are found by name, as with find_by_index()
+        return nullptr;
+    }
     for (ap = AP_Param::first(token, ptype);
          ap && *ptype != AP_PARAM_GROUP && *ptype != AP_PARAM_NONE;
          ap = AP_Param::next_scalar(token, ptype)) {
-        int32_t ret = strncasecmp(name, var_info(token->key).name, AP_MAX_NAME_SIZE);
-        if (ret >= 0) {
-            char buf[AP_MAX_NAME_SIZE];
-            ap->copy_name_token(*token, buf, AP_MAX_NAME_SIZE);
-            if (strncasecmp(name, buf, AP_MAX_NAME_SIZE) == 0) {
-                break;
-            }
+        if (ap == target) {
+            break;
         }
-        count++;
     }
     return ap;
 }
@@ -53,6 +53,15 @@
 #endif
 #endif
 
+/*
+  hash index of parameter names used to speed up find() and
+  find_by_name(). It costs 11 to 22 bytes of RAM per parameter,
+  depending on how the table size rounds to a power of two
+ */
+#ifndef AP_PARAM_NAME_INDEX_ENABLED
+#define AP_PARAM_NAME_INDEX_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX || HAL_MEM_CLASS >= HAL_MEM_CLASS_1000)
+#endif
+
 // allow for dynamically added tables when scripting enabled
 #define AP_PARAM_DYNAMIC_ENABLED AP_SCRIPTING_ENABLED
 
@@ -257,6 +266,42 @@ public:
         uint32_t last_disabled : 1;
     } ParamToken;
 
+    /*
+      a persistent position in the list of scalar parameters, in the
+      order used for parameter indexes. Moving forward costs one
+      next_scalar() per parameter, so looking up ascending indexes,
+      as a GCS does when fetching missing parameters, doesn't restart
+      the walk from the first parameter each time. The cursor restarts
+      itself when the parameter list changes
+     */
+    class ParamCursor {
+    public:
+        // with_defaults requests that default values are tracked
+        ParamCursor(bool with_defaults=false) : _with_defaults(with_defaults) {}
+
+        // move to the parameter with index idx
+        AP_Param *seek(uint16_t idx, enum ap_var_type *ptype);
+
+        // move to the next parameter
+        AP_Param *next(enum ap_var_type *ptype);
+
+        // force the next seek() to start from the first parameter
+        void reset() { _ap = nullptr; }
+
+        const ParamToken &token() const { return _token; }
+        uint16_t index() const { return _index; }
+        float default_value() const { return _default_val; }
+
+    private:
+        ParamToken _token {};
+        AP_Param *_ap = nullptr;
+        enum ap_var_type _type;
+        uint16_t _index;
+        uint16_t _marker;
+        float _default_val;
+        const bool _with_defaults;
+    };
+
 
     // nesting structure for recursive call states
     struct GroupNesting {
@@ -691,6 +736,43 @@ private:
                                     ptrdiff_t group_offset,
                                     const struct GroupInfo *group_info,
                                     enum ap_var_type *ptype);
+    static AP_Param *           find_in_var(
+                                    const char *name,
+                                    uint16_t vindex,
+                                    enum ap_var_type *ptype,
+                                    uint16_t *flags);
+#if AP_PARAM_NAME_INDEX_ENABLED
+    /*
+      open addressed hash table mapping the hash of each scalar
+      parameter name to the top level variable holding it and the
+      first()/next_scalar() token for it. A hit is confirmed with
+      find_in_var(), so a name missing from the index (for example in
+      a hidden group) falls back to the full search
+     */
+    struct NameIndexEntry {
+        uint16_t hash;
+        uint16_t vindex;
+        ParamToken token;
+    };
+    static NameIndexEntry *     _name_index;
+    static uint16_t             _name_index_size;
+    static uint16_t             _name_index_marker;
+    static uint16_t             _name_index_num_vars;
+    static HAL_Semaphore        _name_index_sem;
+    static uint32_t             name_hash(const char *name);
+    static bool                 name_index_valid();
+    static void                 build_name_index();
+    static AP_Param *           find_indexed(
+                                    const char *name,
+                                    enum ap_var_type *ptype,
+                                    uint16_t *flags,
+                                    ParamToken *token = nullptr);
+    static AP_Param *           find_indexed_locked(
+                                    const char *name,
+                                    enum ap_var_type *ptype,
+                                    uint16_t *flags,
+                                    ParamToken *token);
+#endif
     static void                 write_sentinal(uint16_t ofs);
     static uint16_t             get_key(const Param_header &phdr);
     static void                 set_key(Param_header &phdr, uint16_t key);
@@ -66,7 +66,7 @@ const AP_Param::GroupInfo AP_Scheduler::var_info[] = {
     // @Param: OPTIONS
     // @DisplayName: Scheduling options
     // @Description: This controls optional aspects of the scheduler.
-    // @Bitmask: 0:Enable per-task perf info
+    // @Bitmask: 0:Enable per-task perf info, 1:Earliest deadline first scheduling of due tasks
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  2, AP_Scheduler, _options, 0),
 
@@ -131,6 +131,12 @@ void AP_Scheduler::init(const AP_Scheduler::Task *tasks, uint8_t num_tasks, uint
         perf_info.allocate_task_info(_num_tasks);
     }
 
+#if AP_SCHEDULER_EDF_ENABLED
+    if (_options & uint8_t(Options::EDF_SCHEDULING)) {
+        allocate_edf_queue();
+    }
+#endif
+
     _log_performance_bit = log_performance_bit;
 
     // sanity check the task lists to ensure the priorities are
@@ -184,6 +190,14 @@ void AP_Scheduler::run(uint32_t time_available)
     uint8_t vehicle_tasks_offset = 0;
     uint8_t common_tasks_offset = 0;
 
+#if AP_SCHEDULER_EDF_ENABLED
+    // with EDF scheduling the fast tasks run in priority order and
+    // the other due tasks are queued and run in deadline order
+    const bool edf = (_options & uint8_t(Options::EDF_SCHEDULING)) && _edf_queue != nullptr;
+    uint8_t num_due = 0;
+    const uint32_t loop_end_us = run_started_usec + time_available;
+#endif
+
     for (uint8_t i=0; i<_num_tasks; i++) {
         // determine which of the common task / vehicle task to run
         bool run_vehicle_task = false;
@@ -216,6 +230,7 @@ void AP_Scheduler::run(uint32_t time_available)
             common_tasks_offset++;
         }
 
+        uint16_t late_ticks = 0;
         if (task.priority > MAX_FAST_TASK_PRIORITIES) {
             const uint16_t dt = _tick_counter - _last_run[i];
             // we allow 0 to mean loop rate
@@ -229,6 +244,7 @@ void AP_Scheduler::run(uint32_t time_available)
             }
             // this task is due to run. Do we have enough time to run it?
             _task_time_allowed = task.max_time_micros;
+            late_ticks = dt - interval_ticks;
 
             if (dt >= interval_ticks*2) {
                 perf_info.task_slipped(i);
@@ -240,6 +256,13 @@ void AP_Scheduler::run(uint32_t time_available)
                 task_not_achieved++;
             }
 
+#if AP_SCHEDULER_EDF_ENABLED
+            if (edf) {
+                _edf_queue[num_due++] = EDFTask{&task, i, late_ticks};
+                continue;
+            }
+#endif
+
             if (_task_time_allowed > time_available) {
                 // not enough time to run this task.  Continue loop -
                 // maybe another task will fit into time remaining
@@ -249,50 +272,18 @@ void AP_Scheduler::run(uint32_t time_available)
             _task_time_allowed = get_loop_period_us();
         }
 
-        // run it
-        _task_time_started = now;
-        hal.util->persistent_data.scheduler_task = i;
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-        fill_nanf_stack();
-#endif
-        task.function();
-        hal.util->persistent_data.scheduler_task = -1;
-
-        // record the tick counter when we ran. This drives
-        // when we next run the event
-        _last_run[i] = _tick_counter;
-
-        // work out how long the event actually took
-        now = AP_HAL::micros();
-        uint32_t time_taken = now - _task_time_started;
-        bool overrun = false;
-        if (time_taken > _task_time_allowed) {
-            overrun = true;
-            // the event overran!
-            debug(3, "Scheduler overrun task[%u-%s] (%u/%u)\n",
-                  (unsigned)i,
-                  task.name,
-                  (unsigned)time_taken,
-                  (unsigned)_task_time_allowed);
-        }
+        run_task(task, i, late_ticks, now, time_available);
+    }
 
-        perf_info.update_task_info(i, time_taken, overrun);
-
-        if (time_taken >= time_available) {
-            /*
-              we are out of time, but we need to keep walking the task
-              table in case there is another fast loop task after this
-              task, plus we need to update the accouting so we can
-              work out if we need to allocate extra time for the loop
-              (lower the loop rate)
-              Just set time_available to zero, which means we will
-              only run fast tasks after this one
-             */
-            time_available = 0;
-        } else {
-            time_available -= time_taken;
-        }
+#if AP_SCHEDULER_EDF_ENABLED
+    if (edf) {
+        run_edf_queue(num_due, loop_end_us, now, time_available);
+
+        // pay back what this loop borrowed and bank its spare time
+        // for overdue tasks in later loops
+        _edf_spare.end_loop(now, time_available, get_loop_period_us() / 5);
     }
+#endif
 
     // update number of spare microseconds
     _spare_micros += time_available;
@@ -304,6 +295,113 @@ void AP_Scheduler::run(uint32_t time_available)
     }
 }
 
+/*
+  run a single task and update the time available in this loop
+ */
+void AP_Scheduler::run_task(const Task &task, uint8_t i, uint16_t late_ticks,
+                            uint32_t &now, uint32_t &time_available)
+{
+    // run it
+    _task_time_started = now;
+    hal.util->persistent_data.scheduler_task = i;
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    fill_nanf_stack();
+#endif
+    task.function();
+    hal.util->persistent_data.scheduler_task = -1;
+
+    // record the tick counter when we ran. This drives
+    // when we next run the event
+    _last_run[i] = _tick_counter;
+
+    // work out how long the event actually took
+    now = AP_HAL::micros();
+    uint32_t time_taken = now - _task_time_started;
+    bool overrun = false;
+    if (time_taken > _task_time_allowed) {
+        overrun = true;
+        // the event overran!
+        debug(3, "Scheduler overrun task[%u-%s] (%u/%u)\n",
+              (unsigned)i,
+              task.name,
+              (unsigned)time_taken,
+              (unsigned)_task_time_allowed);
+    }
+
+    perf_info.update_task_info(i, time_taken, late_ticks, overrun);
+
+    if (time_taken >= time_available) {
+        /*
+          we are out of time, but we need to keep walking the task
+          table in case there is another fast loop task after this
+          task, plus we need to update the accouting so we can
+          work out if we need to allocate extra time for the loop
+          (lower the loop rate)
+          Just set time_available to zero, which means we will
+          only run fast tasks after this one
+         */
+        time_available = 0;
+    } else {
+        time_available -= time_taken;
+    }
+}
+
+#if AP_SCHEDULER_EDF_ENABLED
+// allocate the queue used for earliest deadline first scheduling
+void AP_Scheduler::allocate_edf_queue()
+{
+    if (_edf_queue != nullptr) {
+        return;
+    }
+    _edf_queue = new EDFTask[_num_tasks];
+    if (_edf_queue == nullptr) {
+        DEV_PRINTF("Unable to allocate scheduler EDF queue\n");
+    }
+}
+
+/*
+  run the due tasks queued by run() in deadline order. The deadline of
+  a task is the tick it became due, so the task which has been waiting
+  longest runs first. Ties keep the table priority order.
+
+  Tasks which are already late may also use spare time left over from
+  previous short loops, which lets heavy tasks that rarely fit in the
+  remaining time of a fast loop run without waiting for a slip. The
+  late tasks of a loop share one borrowing limit, taken from the
+  overtime margin of the loop, so however many are late the loop is
+  not long running.
+ */
+void AP_Scheduler::run_edf_queue(uint8_t num_due, uint32_t loop_end_us, uint32_t &now, uint32_t &time_available)
+{
+    // insertion sort, most overdue first. This is stable, so ties
+    // stay in priority order
+    for (uint8_t i = 1; i < num_due; i++) {
+        const EDFTask t = _edf_queue[i];
+        uint8_t j = i;
+        while (j > 0 && _edf_queue[j-1].late_ticks < t.late_ticks) {
+            _edf_queue[j] = _edf_queue[j-1];
+            j--;
+        }
+        _edf_queue[j] = t;
+    }
+
+    // a loop is long running beyond 1.2 loop periods. Borrow at most
+    // half of that margin, less any extra loop time already given,
+    // leaving room for the rest of the loop
+    const uint32_t margin_us = get_loop_period_us() / 10;
+    _edf_spare.begin_loop(loop_end_us, margin_us - MIN(margin_us, extra_loop_us));
+
+    for (uint8_t i = 0; i < num_due; i++) {
+        const EDFTask &t = _edf_queue[i];
+        _task_time_allowed = t.task->max_time_micros;
+        if (!_edf_spare.may_run(now, _task_time_allowed, t.late_ticks > 0)) {
+            continue;
+        }
+        run_task(*t.task, t.task_index, t.late_ticks, now, time_available);
+    }
+}
+#endif // AP_SCHEDULER_EDF_ENABLED
+
 /*
   return number of micros until the current task reaches its deadline
  */
@@ -425,6 +523,9 @@ void AP_Scheduler::update_logging()
     if (_log_performance_bit != (uint32_t)-1 &&
         AP::logger().should_log(_log_performance_bit)) {
         Log_Write_Performance();
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+        Log_Write_TaskHistograms();
+#endif
     }
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
@@ -434,6 +535,12 @@ void AP_Scheduler::update_logging()
     } else if ((_options & uint8_t(Options::RECORD_TASK_INFO)) && !perf_info.has_task_info()) {
         perf_info.allocate_task_info(_num_tasks);
     }
+#if AP_SCHEDULER_EDF_ENABLED
+    // the queue is never freed as update_logging() runs inside run()
+    if (_options & uint8_t(Options::EDF_SCHEDULING)) {
+        allocate_edf_queue();
+    }
+#endif
 }
 
 // Write a performance monitoring packet
@@ -460,11 +567,55 @@ void AP_Scheduler::Log_Write_Performance()
     AP::logger().WriteCriticalBlock(&pkt, sizeof(pkt));
 }
 
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+// Write a summary of the run time and lateness histograms for the
+// next AP_SCHEDULER_TASK_HISTOGRAM_LOG_MAX tasks which ran since the
+// last call, in turn, so that the number of messages per call is
+// bounded. Only available when per-task perf info is enabled
+void AP_Scheduler::Log_Write_TaskHistograms()
+{
+    if (_num_tasks == 0 || perf_info.get_task_info(0) == nullptr) {
+        return;
+    }
+    const uint64_t now_us = AP_HAL::micros64();
+    uint8_t written = 0;
+    for (uint8_t n = 0; n < _num_tasks && written < AP_SCHEDULER_TASK_HISTOGRAM_LOG_MAX; n++) {
+        const uint8_t i = _task_hist_log_next;
+        _task_hist_log_next = (_task_hist_log_next + 1) % _num_tasks;
+        const AP::PerfInfo::TaskInfo* ti = perf_info.get_task_info(i);
+        if (ti == nullptr || ti->tick_count == 0) {
+            continue;
+        }
+        struct log_TaskHistogram pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_TASK_HISTOGRAM_MSG),
+            time_us       : now_us,
+            task_index    : i,
+            tick_count    : (uint16_t)MIN(ti->tick_count, UINT16_MAX),
+            p50_us        : ti->run_time_percentile(0.5f),
+            p90_us        : ti->run_time_percentile(0.9f),
+            p99_us        : ti->run_time_percentile(0.99f),
+            max_us        : ti->max_time_us,
+            late_p50      : ti->late_ticks_percentile(0.5f),
+            late_p99      : ti->late_ticks_percentile(0.99f),
+            slip_count    : ti->slip_count,
+            overrun_count : ti->overrun_count,
+            long_loops    : ti->long_loop_count,
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+        written++;
+    }
+}
+#endif
+
 // display task statistics as text buffer for @SYS/tasks.txt
 void AP_Scheduler::task_info(ExpandingString &str)
 {
     // a header to allow for machine parsers to determine format
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    str.printf("TasksV3\n");
+#else
     str.printf("TasksV2\n");
+#endif
 
     // dynamically enable statistics collection
     if (!(_options & uint8_t(Options::RECORD_TASK_INFO))) {
@@ -524,6 +675,13 @@ void AP_Scheduler::task_info(ExpandingString &str)
 
         ti->print(task_name, total_time, str);
     }
+
+    // notch updates are a sub-measurement of the INS fast task,
+    // reported after the tasks when a harmonic notch is active
+    const AP::PerfInfo::TaskInfo &notch_info = perf_info.get_notch_info();
+    if (notch_info.tick_count > 0) {
+        notch_info.print("AP_InertialSensor::update:notch", total_time, str);
+    }
 }
 
 namespace AP {
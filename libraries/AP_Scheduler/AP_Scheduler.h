@@ -27,6 +27,7 @@
 #include <AP_HAL/Util.h>
 #include <AP_Math/AP_Math.h>
 #include "PerfInfo.h"       // loop perf monitoring
+#include "AP_Scheduler_SpareTime.h"
 
 #if AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED
 #define AP_SCHEDULER_NAME_INITIALIZER(_clazz,_name) .name = #_clazz "::" #_name,
@@ -91,7 +92,8 @@ public:
     };
 
     enum class Options : uint8_t {
-        RECORD_TASK_INFO = 1 << 0
+        RECORD_TASK_INFO = 1 << 0,
+        EDF_SCHEDULING   = 1 << 1,
     };
 
     enum FastTaskPriorities {
@@ -114,6 +116,12 @@ public:
     // write out PERF message to logger
     void Log_Write_Performance();
 
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    // write out TSKH messages summarising the histograms of the next
+    // few tasks in turn
+    void Log_Write_TaskHistograms();
+#endif
+
     // call when one tick has passed
     void tick(void);
 
@@ -218,6 +226,11 @@ private:
     // total number of tasks in _tasks and _common_tasks list
     uint8_t _num_tasks;
 
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    // next task to write a TSKH message for
+    uint8_t _task_hist_log_next;
+#endif
+
     // number of 'ticks' that have passed (number of times that
     // tick() has been called
     uint16_t _tick_counter;
@@ -263,6 +276,29 @@ private:
 
     // semaphore that is held while not waiting for ins samples
     HAL_Semaphore _rsem;
+
+    // run a single task, updating the remaining time available
+    void run_task(const Task &task, uint8_t task_index, uint16_t late_ticks,
+                  uint32_t &now, uint32_t &time_available);
+
+#if AP_SCHEDULER_EDF_ENABLED
+    // a task which is due to run, queued for deadline ordering
+    struct EDFTask {
+        const Task *task;
+        uint8_t task_index;
+        uint16_t late_ticks;
+    };
+    // due tasks for the current loop, allocated when EDF scheduling
+    // is first enabled
+    EDFTask *_edf_queue;
+
+    // spare time from previous short loops which overdue tasks may
+    // borrow
+    AP_Scheduler_SpareTime _edf_spare;
+
+    void allocate_edf_queue();
+    void run_edf_queue(uint8_t num_due, uint32_t loop_end_us, uint32_t &now, uint32_t &time_available);
+#endif
 };
 
 namespace AP {
@@ -0,0 +1,45 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_Scheduler_SpareTime.h"
+
+#if AP_SCHEDULER_EDF_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+void AP_Scheduler_SpareTime::begin_loop(uint32_t loop_end_us, uint32_t margin_us)
+{
+    _loop_end_us = loop_end_us;
+    _borrow_limit_us = MIN(_banked_us, margin_us);
+}
+
+bool AP_Scheduler_SpareTime::may_run(uint32_t now_us, uint32_t max_time_us, bool late) const
+{
+    // time left in this loop, which is negative once an earlier task
+    // has run past its end
+    const int32_t time_left_us = int32_t(_loop_end_us - now_us) + (late ? int32_t(_borrow_limit_us) : 0);
+    return time_left_us >= 0 && max_time_us <= uint32_t(time_left_us);
+}
+
+void AP_Scheduler_SpareTime::end_loop(uint32_t now_us, uint32_t spare_us, uint32_t max_us)
+{
+    const int32_t borrowed_us = int32_t(now_us - _loop_end_us);
+    if (borrowed_us > 0) {
+        _banked_us -= MIN(_banked_us, uint32_t(borrowed_us));
+    }
+    _banked_us = MIN(_banked_us + spare_us, max_us);
+}
+
+#endif // AP_SCHEDULER_EDF_ENABLED
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "AP_Scheduler_config.h"
+
+#if AP_SCHEDULER_EDF_ENABLED
+
+#include <stdint.h>
+
+/*
+  spare time banked from loops which finished early, which overdue
+  tasks may borrow under EDF scheduling. All the tasks of one loop
+  share a single borrowing limit, so several late tasks can't each
+  run past the end of the loop
+ */
+class AP_Scheduler_SpareTime
+{
+public:
+    // start the due tasks of a loop which ends at loop_end_us.
+    // margin_us is how far the loop may run past its end
+    void begin_loop(uint32_t loop_end_us, uint32_t margin_us);
+
+    // true if a task with a budget of max_time_us may start at now_us.
+    // Only late tasks may borrow
+    bool may_run(uint32_t now_us, uint32_t max_time_us, bool late) const;
+
+    // pay back any time the loop ran past its end, then bank
+    // spare_us, keeping at most max_us
+    void end_loop(uint32_t now_us, uint32_t spare_us, uint32_t max_us);
+
+    uint32_t banked_us() const { return _banked_us; }
+
+private:
+    uint32_t _banked_us;
+    uint32_t _loop_end_us;
+    uint32_t _borrow_limit_us;  // may run to _loop_end_us plus this
+};
+
+#endif // AP_SCHEDULER_EDF_ENABLED
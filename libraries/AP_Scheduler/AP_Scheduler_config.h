@@ -9,3 +9,18 @@
 #ifndef AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED
 #define AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED 1
 #endif
+
+// per-task log2 histograms of run time and start lateness
+#ifndef AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+#define AP_SCHEDULER_TASK_HISTOGRAM_ENABLED 1
+#endif
+
+// maximum number of TSKH messages written per update_logging() call
+#ifndef AP_SCHEDULER_TASK_HISTOGRAM_LOG_MAX
+#define AP_SCHEDULER_TASK_HISTOGRAM_LOG_MAX 6
+#endif
+
+// optional earliest deadline first ordering of due tasks
+#ifndef AP_SCHEDULER_EDF_ENABLED
+#define AP_SCHEDULER_EDF_ENABLED 1
+#endif
@@ -25,6 +25,7 @@ void AP::PerfInfo::reset()
     if (_task_info != nullptr) {
         memset(_task_info, 0, (_num_tasks) * sizeof(TaskInfo));
     }
+    memset(&_notch_info, 0, sizeof(_notch_info));
 }
 
 // ignore_loop - ignore this loop from performance measurements (used to reduce false positive when arming)
@@ -53,7 +54,7 @@ void AP::PerfInfo::free_task_info()
 }
 
 // called after each run of a task to update its statistics based on measurements taken by the scheduler
-void AP::PerfInfo::update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun)
+void AP::PerfInfo::update_task_info(uint8_t task_index, uint16_t task_time_us, uint16_t late_ticks, bool overrun)
 {
     if (_task_info == nullptr) {
         return;
@@ -64,10 +65,61 @@ void AP::PerfInfo::update_task_info(uint8_t task_index, uint16_t task_time_us, b
         return;
     }
     TaskInfo& ti = _task_info[task_index];
-    ti.update(task_time_us, overrun);
+    ti.update(task_time_us, late_ticks, overrun);
+
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    if (_loop_slowest_task < 0 || task_time_us > _loop_slowest_time_us) {
+        _loop_slowest_task = task_index;
+        _loop_slowest_time_us = task_time_us;
+    }
+#endif
+}
+
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+// add a value to a log2 histogram, saturating the bucket count
+static void hist_add(uint16_t *hist, uint16_t value)
+{
+    uint8_t bucket = 0;
+    while (value != 0 && bucket < PERFINFO_HIST_BUCKETS-1) {
+        value >>= 1;
+        bucket++;
+    }
+    if (hist[bucket] < UINT16_MAX) {
+        hist[bucket]++;
+    }
+}
+
+// return the upper bound of the bucket holding percentile p of a
+// log2 histogram, or max_value if that is smaller
+static uint16_t hist_percentile(const uint16_t *hist, float p, uint16_t max_value)
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < PERFINFO_HIST_BUCKETS; i++) {
+        total += hist[i];
+    }
+    const uint32_t target = MAX(uint32_t(total * p + 0.5f), 1U);
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < PERFINFO_HIST_BUCKETS-1; i++) {
+        count += hist[i];
+        if (count >= target) {
+            return MIN(uint16_t((1U << i) - 1), max_value);
+        }
+    }
+    return max_value;
 }
 
-void AP::PerfInfo::TaskInfo::update(uint16_t task_time_us, bool overrun)
+uint16_t AP::PerfInfo::TaskInfo::run_time_percentile(float p) const
+{
+    return hist_percentile(run_time_hist, p, max_time_us);
+}
+
+uint16_t AP::PerfInfo::TaskInfo::late_ticks_percentile(float p) const
+{
+    return hist_percentile(late_ticks_hist, p, UINT16_MAX);
+}
+#endif // AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+
+void AP::PerfInfo::TaskInfo::update(uint16_t task_time_us, uint16_t late_ticks, bool overrun)
 {
     max_time_us = MAX(max_time_us, task_time_us);
     if (min_time_us == 0) {
@@ -80,6 +132,10 @@ void AP::PerfInfo::TaskInfo::update(uint16_t task_time_us, bool overrun)
     if (overrun) {
         overrun_count++;
     }
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    hist_add(run_time_hist, task_time_us);
+    hist_add(late_ticks_hist, late_ticks);
+#endif
 }
 
 void AP::PerfInfo::TaskInfo::print(const char* task_name, uint32_t total_time, ExpandingString& str) const
@@ -91,13 +147,27 @@ void AP::PerfInfo::TaskInfo::print(const char* task_name, uint32_t total_time, E
         avg = MIN(uint16_t(elapsed_time_us / tick_count), 9999);
     }
 #if AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED
-    const char* fmt = "%-32.32s MIN=%4u MAX=%4u AVG=%4u OVR=%3u SLP=%3u, TOT=%4.1f%%\n";
+    const char* fmt = "%-32.32s MIN=%4u MAX=%4u AVG=%4u OVR=%3u SLP=%3u, TOT=%4.1f%%";
 #else
-    const char* fmt = "%-16.16s MIN=%4u MAX=%4u AVG=%4u OVR=%3u SLP=%3u, TOT=%4.1f%%\n";
+    const char* fmt = "%-16.16s MIN=%4u MAX=%4u AVG=%4u OVR=%3u SLP=%3u, TOT=%4.1f%%";
 #endif
     str.printf(fmt, task_name,
                 unsigned(MIN(min_time_us, 9999)), unsigned(MIN(max_time_us, 9999)), unsigned(avg),
                 unsigned(MIN(overrun_count, 999)), unsigned(MIN(slip_count, 999)), pct);
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    uint16_t p50 = 0, p99 = 0, late50 = 0, late99 = 0;
+    if (tick_count > 0) {
+        p50 = run_time_percentile(0.5f);
+        p99 = run_time_percentile(0.99f);
+        late50 = late_ticks_percentile(0.5f);
+        late99 = late_ticks_percentile(0.99f);
+    }
+    str.printf(" P50=%4u P99=%4u LT50=%3u LT99=%3u LNG=%3u",
+               unsigned(MIN(p50, 9999)), unsigned(MIN(p99, 9999)),
+               unsigned(MIN(late50, 999)), unsigned(MIN(late99, 999)),
+               unsigned(MIN(long_loop_count, 999)));
+#endif
+    str.printf("\n");
 }
 
 // check_loop_time - check latest loop time vs min, max and overtime threshold
@@ -105,6 +175,12 @@ void AP::PerfInfo::check_loop_time(uint32_t time_in_micros)
 {
     loop_count++;
 
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    const int16_t prev_loop_slowest_task = _prev_loop_slowest_task;
+    _prev_loop_slowest_task = _loop_slowest_task;
+    _loop_slowest_task = -1;
+#endif
+
     // exit if this loop should be ignored
     if (ignore_loop) {
         ignore_loop = false;
@@ -119,6 +195,16 @@ void AP::PerfInfo::check_loop_time(uint32_t time_in_micros)
     }
     if (time_in_micros > overtime_threshold_micros) {
         long_running++;
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+        // the measured time is that of the previous loop, so blame
+        // the slowest task that ran in it
+        if (_task_info != nullptr && prev_loop_slowest_task >= 0 && prev_loop_slowest_task < _num_tasks) {
+            TaskInfo &ti = _task_info[prev_loop_slowest_task];
+            if (ti.long_loop_count < UINT16_MAX) {
+                ti.long_loop_count++;
+            }
+        }
+#endif
     }
     sigma_time += time_in_micros;
     sigmasquared_time += time_in_micros * time_in_micros;
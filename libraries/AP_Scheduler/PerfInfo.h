@@ -2,6 +2,12 @@
 
 #include <stdint.h>
 #include <AP_Common/ExpandingString.h>
+#include "AP_Scheduler_config.h"
+
+// number of log2 buckets in each task histogram. Bucket 0 counts
+// zero values, bucket n counts values in [2^(n-1), 2^n) and the
+// last bucket counts everything larger
+#define PERFINFO_HIST_BUCKETS 14
 
 namespace AP {
 
@@ -17,8 +23,18 @@ public:
         uint32_t tick_count;
         uint16_t slip_count;
         uint16_t overrun_count;
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+        uint16_t long_loop_count;   // long running loops in which this was the slowest task
+        uint16_t run_time_hist[PERFINFO_HIST_BUCKETS];   // task run time in microseconds
+        uint16_t late_ticks_hist[PERFINFO_HIST_BUCKETS]; // ticks the task started after it was due
+
+        // percentile p (0 to 1) of the run time in microseconds
+        uint16_t run_time_percentile(float p) const;
+        // percentile p (0 to 1) of the start lateness in ticks
+        uint16_t late_ticks_percentile(float p) const;
+#endif
 
-        void update(uint16_t task_time_us, bool overrun);
+        void update(uint16_t task_time_us, uint16_t late_ticks, bool overrun);
         void print(const char* task_name, uint32_t total_time, ExpandingString& str) const;
     };
 
@@ -50,14 +66,23 @@ public:
         return (_task_info && task_index < _num_tasks) ? &_task_info[task_index] : nullptr;
     }
     // called after each run of a task to update its statistics based on measurements taken by the scheduler
-    void update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun);
+    // late_ticks is the number of ticks past its scheduled tick that the task started
+    void update_task_info(uint8_t task_index, uint16_t task_time_us, uint16_t late_ticks, bool overrun);
     // record that a task slipped
     void task_slipped(uint8_t task_index) {
         if (_task_info && task_index < _num_tasks) {
-            _task_info[task_index].overrun_count++;
+            _task_info[task_index].slip_count++;
         }
     }
 
+    // record the time taken to update the harmonic notch filter
+    // coefficients. This is part of the INS fast task and is already
+    // included in its time
+    void update_notch_info(uint16_t time_us) {
+        _notch_info.update(time_us, 0, false);
+    }
+    const TaskInfo &get_notch_info() const { return _notch_info; }
+
 private:
     uint16_t loop_rate_hz;
     uint16_t overtime_threshold_micros;
@@ -73,6 +98,14 @@ private:
     // performance monitoring
     uint8_t _num_tasks;
     TaskInfo* _task_info;
+    TaskInfo _notch_info;
+#if AP_SCHEDULER_TASK_HISTOGRAM_ENABLED
+    // slowest task of the current and previous loops, used to find
+    // the task responsible for a long running loop
+    int16_t _loop_slowest_task = -1;
+    uint16_t _loop_slowest_time_us;
+    int16_t _prev_loop_slowest_task = -1;
+#endif
 };
 
 };
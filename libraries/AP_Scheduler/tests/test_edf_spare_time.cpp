@@ -0,0 +1,112 @@
+#include <AP_gtest.h>
+#include <AP_Scheduler/AP_Scheduler_SpareTime.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_SCHEDULER_EDF_ENABLED
+
+// 400Hz loop, borrowing from half of the 20% overtime margin as the
+// scheduler does
+static const uint32_t loop_us = 2500;
+static const uint32_t margin_us = loop_us / 10;
+static const uint32_t bank_max_us = loop_us / 5;
+
+/*
+  run one loop's late tasks, each taking its full budget, returning
+  the time the loop finished
+ */
+static uint32_t run_loop(AP_Scheduler_SpareTime &spare, uint32_t start_us, uint32_t time_available_us,
+                         const uint32_t *task_us, uint8_t num_tasks, bool late, uint8_t &num_run)
+{
+    const uint32_t loop_end_us = start_us + time_available_us;
+    spare.begin_loop(loop_end_us, margin_us);
+    uint32_t now_us = start_us;
+    num_run = 0;
+    for (uint8_t i=0; i<num_tasks; i++) {
+        if (spare.may_run(now_us, task_us[i], late)) {
+            now_us += task_us[i];
+            num_run++;
+        }
+    }
+    const int32_t spare_us = int32_t(loop_end_us - now_us);
+    spare.end_loop(now_us, spare_us > 0 ? spare_us : 0, bank_max_us);
+    return now_us;
+}
+
+// several late tasks at once share one borrowing limit, so the loop
+// never runs further past its end than the margin
+TEST(EDFSpareTime, SeveralLateTasksNoOverrun)
+{
+    AP_Scheduler_SpareTime spare {};
+    uint8_t num_run;
+
+    // bank the maximum from idle loops
+    uint32_t now_us = 1000;
+    for (uint8_t i=0; i<10; i++) {
+        now_us = run_loop(spare, now_us, loop_us, nullptr, 0, true, num_run);
+    }
+    EXPECT_EQ(spare.banked_us(), bank_max_us);
+
+    // a busy loop with 100us left and six late tasks which each
+    // only fit by borrowing
+    const uint32_t task_us[] { 150, 150, 150, 150, 150, 150 };
+    const uint32_t start_us = 50000;
+    const uint32_t end_us = run_loop(spare, start_us, 100, task_us, ARRAY_SIZE(task_us), true, num_run);
+    EXPECT_GE(num_run, 1U);
+    EXPECT_LT(num_run, ARRAY_SIZE(task_us));
+    EXPECT_LE(end_us, start_us + 100 + margin_us);
+
+    // the borrowed time has been paid back
+    EXPECT_EQ(spare.banked_us(), bank_max_us - (end_us - (start_us + 100)));
+}
+
+// tasks which aren't late never borrow
+TEST(EDFSpareTime, OnlyLateTasksBorrow)
+{
+    AP_Scheduler_SpareTime spare {};
+    uint8_t num_run;
+    run_loop(spare, 1000, loop_us, nullptr, 0, true, num_run);
+    ASSERT_GT(spare.banked_us(), 0U);
+
+    const uint32_t task_us[] { 150 };
+    const uint32_t end_us = run_loop(spare, 10000, 100, task_us, 1, false, num_run);
+    EXPECT_EQ(num_run, 0U);
+    EXPECT_EQ(end_us, 10000U);
+}
+
+// once a loop has run past its end no task may start, even with time
+// in the bank
+TEST(EDFSpareTime, NoBorrowingAfterOverrun)
+{
+    AP_Scheduler_SpareTime spare {};
+    uint8_t num_run;
+    run_loop(spare, 1000, loop_us, nullptr, 0, true, num_run);
+    ASSERT_EQ(spare.banked_us(), bank_max_us);
+
+    // the fast tasks have already taken the loop past its end
+    spare.begin_loop(10000, margin_us);
+    EXPECT_FALSE(spare.may_run(10000 + margin_us + 1, 0, true));
+    EXPECT_TRUE(spare.may_run(10000 + margin_us - 10, 10, true));
+    EXPECT_FALSE(spare.may_run(10000 + margin_us - 10, 11, true));
+    spare.end_loop(10000 + 300, 0, bank_max_us);
+    EXPECT_EQ(spare.banked_us(), bank_max_us - 300);
+}
+
+// the clock wrapping during a loop is handled
+TEST(EDFSpareTime, MicrosWrap)
+{
+    AP_Scheduler_SpareTime spare {};
+    uint8_t num_run;
+    run_loop(spare, 1000, loop_us, nullptr, 0, true, num_run);
+
+    const uint32_t task_us[] { 150, 150, 150 };
+    const uint32_t start_us = UINT32_MAX - 50;
+    const uint32_t end_us = run_loop(spare, start_us, 100, task_us, ARRAY_SIZE(task_us), true, num_run);
+    EXPECT_EQ(num_run, 2U);
+    EXPECT_EQ(end_us, start_us + 300);
+    EXPECT_EQ(spare.banked_us(), 500U - 200U);
+}
+
+#endif // AP_SCHEDULER_EDF_ENABLED
+
+AP_GTEST_MAIN()
@@ -704,6 +704,15 @@ void AP_Vehicle::update_dynamic_notch(AP_InertialSensor::HarmonicNotch &notch)
                 float center_freq = gyro_fft.get_weighted_noise_center_freq_hz();
                 if (!is_zero(center_freq)) {
                     notch.update_freq_hz(MAX(ref_freq, center_freq));
+                    // IMUs with their own signal track their own noise peak
+                    if (gyro_fft.analysing_all_imus()) {
+                        for (uint8_t i = 0; i < INS_MAX_INSTANCES; i++) {
+                            const float imu_freq = gyro_fft.get_imu_weighted_noise_center_freq_hz(i);
+                            if (!is_zero(imu_freq)) {
+                                notch.update_imu_freq_hz(i, MAX(ref_freq, imu_freq));
+                            }
+                        }
+                    }
                 } else {    // since FFT can be used post-filter it is better to disable the notch when there is no data
                     notch.set_inactive(true);
                 }
@@ -24,6 +24,18 @@
 #define HNF_MAX_FILTERS HAL_HNF_MAX_FILTERS // must be even for double-notch filters
 #define HNF_MAX_HARMONICS 8
 
+// notches whose target center frequency has moved by less than this
+// fraction keep their coefficients
+#ifndef HNF_FREQ_TOLERANCE
+#define HNF_FREQ_TOLERANCE 0.002f
+#endif
+
+// maximum number of notches to recalculate coefficients for in one
+// update, further notches are deferred to the next update
+#ifndef HNF_MAX_COEFF_UPDATES
+#define HNF_MAX_COEFF_UPDATES 16
+#endif
+
 // table of user settable parameters
 const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
 
@@ -106,6 +118,9 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
 template <class T>
 HarmonicNotchFilter<T>::~HarmonicNotchFilter() {
     delete[] _filters;
+    delete[] _coeffs;
+    delete[] _state;
+    delete[] _target_freq_hz;
     _num_filters = 0;
     _num_enabled_filters = 0;
 }
@@ -133,7 +148,7 @@ void HarmonicNotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, fl
 
     // position the individual notches so that the attenuation is no worse than a single notch
     // calculate attenuation and quality from the shaping constraints
-    NotchFilter<T>::calculate_A_and_Q(center_freq_hz, bandwidth_hz / _composite_notches, attenuation_dB, _A, _Q);
+    NotchFilterBase::calculate_A_and_Q(center_freq_hz, bandwidth_hz / _composite_notches, attenuation_dB, _A, _Q);
 
     _initialised = true;
     update(center_freq_hz);
@@ -151,9 +166,21 @@ void HarmonicNotchFilter<T>::allocate_filters(uint8_t num_notches, uint8_t harmo
     _harmonics = harmonics;
 
     if (_num_filters > 0) {
-        _filters = new NotchFilter<T>[_num_filters];
-        if (_filters == nullptr) {
-            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Failed to allocate %u bytes for notch filter", (unsigned int)(_num_filters * sizeof(NotchFilter<T>)));
+        _filters = new NotchFilterBase[_num_filters];
+        _coeffs = new NotchCoeffs[_num_filters];
+        _state = new float[_num_filters * 4 * _axes];
+        _target_freq_hz = new float[_num_filters];
+        if (_filters == nullptr || _coeffs == nullptr || _state == nullptr || _target_freq_hz == nullptr) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Failed to allocate %u bytes for notch filter",
+                          (unsigned int)(_num_filters * (sizeof(NotchFilterBase) + sizeof(NotchCoeffs) + 4 * sizeof(T) + sizeof(float))));
+            delete[] _filters;
+            delete[] _coeffs;
+            delete[] _state;
+            delete[] _target_freq_hz;
+            _filters = nullptr;
+            _coeffs = nullptr;
+            _state = nullptr;
+            _target_freq_hz = nullptr;
             _num_filters = 0;
         }
     }
@@ -178,16 +205,35 @@ void HarmonicNotchFilter<T>::expand_filter_count(uint8_t num_notches)
       note that we rely on the semaphore in
       AP_InertialSensor_Backend.cpp to make this thread safe
      */
-    auto filters = new NotchFilter<T>[num_filters];
-    if (filters == nullptr) {
+    auto filters = new NotchFilterBase[num_filters];
+    auto coeffs = new NotchCoeffs[num_filters];
+    auto state = new float[num_filters * 4 * _axes];
+    auto target_freq_hz = new float[num_filters];
+    if (filters == nullptr || coeffs == nullptr || state == nullptr || target_freq_hz == nullptr) {
+        delete[] filters;
+        delete[] coeffs;
+        delete[] state;
+        delete[] target_freq_hz;
         _alloc_has_failed = true;
         return;
     }
     memcpy(filters, _filters, sizeof(filters[0])*_num_filters);
+    memcpy(coeffs, _coeffs, sizeof(coeffs[0])*_num_filters);
+    memcpy(state, _state, sizeof(state[0])*_num_filters*4*_axes);
+    memcpy(target_freq_hz, _target_freq_hz, sizeof(target_freq_hz[0])*_num_filters);
     auto _old_filters = _filters;
+    auto _old_coeffs = _coeffs;
+    auto _old_state = _state;
+    auto _old_target_freq_hz = _target_freq_hz;
     _filters = filters;
+    _coeffs = coeffs;
+    _state = state;
+    _target_freq_hz = target_freq_hz;
     _num_filters = num_filters;
     delete[] _old_filters;
+    delete[] _old_coeffs;
+    delete[] _old_state;
+    delete[] _old_target_freq_hz;
 }
 
 /*
@@ -205,6 +251,7 @@ void HarmonicNotchFilter<T>::update(float center_freq_hz)
     const float nyquist_limit = _sample_freq_hz * 0.48f;
     center_freq_hz = constrain_float(center_freq_hz, 1.0f, nyquist_limit);
 
+    const uint8_t num_enabled_before = _num_enabled_filters;
     _num_enabled_filters = 0;
     // update all of the filters using the new center frequency and existing A & Q
     for (uint8_t i = 0; i < HNF_MAX_HARMONICS && _num_enabled_filters < _num_filters; i++) {
@@ -213,7 +260,7 @@ void HarmonicNotchFilter<T>::update(float center_freq_hz)
             if (_composite_notches != 2) {
                 // only enable the filter if its center frequency is below the nyquist frequency
                 if (notch_center < nyquist_limit) {
-                    _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center, _A, _Q);
+                    _target_freq_hz[_num_enabled_filters++] = notch_center;
                 }
             }
             if (_composite_notches > 1) {
@@ -221,16 +268,18 @@ void HarmonicNotchFilter<T>::update(float center_freq_hz)
                 // only enable the filter if its center frequency is below the nyquist frequency
                 notch_center_double = notch_center * (1.0 - _notch_spread);
                 if (notch_center_double < nyquist_limit) {
-                    _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
+                    _target_freq_hz[_num_enabled_filters++] = notch_center_double;
                 }
                 // only enable the filter if its center frequency is below the nyquist frequency
                 notch_center_double = notch_center * (1.0 + _notch_spread);
                 if (notch_center_double < nyquist_limit) {
-                    _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
+                    _target_freq_hz[_num_enabled_filters++] = notch_center_double;
                 }
             }
         }
     }
+
+    update_coeffs(num_enabled_before);
 }
 
 /*
@@ -252,6 +301,7 @@ void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq
         expand_filter_count(num_centers);
     }
 
+    const uint8_t num_enabled_before = _num_enabled_filters;
     _num_enabled_filters = 0;
 
     // update all of the filters using the new center frequencies and existing A & Q
@@ -268,7 +318,7 @@ void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq
         if (_composite_notches != 2) {
             // only enable the filter if its center frequency is below the nyquist frequency
             if (notch_center < nyquist_limit) {
-                _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center, _A, _Q);
+                _target_freq_hz[_num_enabled_filters++] = notch_center;
             }
         }
         if (_composite_notches > 1) {
@@ -276,15 +326,81 @@ void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq
             // only enable the filter if its center frequency is below the nyquist frequency
             notch_center_double = notch_center * (1.0 - _notch_spread);
             if (notch_center_double < nyquist_limit) {
-                _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
+                _target_freq_hz[_num_enabled_filters++] = notch_center_double;
             }
             // only enable the filter if its center frequency is below the nyquist frequency
             notch_center_double = notch_center * (1.0 + _notch_spread);
             if (notch_center_double < nyquist_limit) {
-                _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
+                _target_freq_hz[_num_enabled_filters++] = notch_center_double;
+            }
+        }
+    }
+
+    update_coeffs(num_enabled_before);
+}
+
+/*
+  recalculate the coefficients of the enabled notches whose target
+  center frequency has moved, and copy them into the filter bank. Small
+  moves are ignored and at most HNF_MAX_COEFF_UPDATES notches are
+  recalculated per call, carrying on from where the last call stopped
+ */
+template <class T>
+void HarmonicNotchFilter<T>::update_coeffs(uint8_t num_enabled_before)
+{
+    // notches that have just been enabled or reset need to be started
+    // from the steady state
+    uint8_t num_valid = MIN(_num_valid_states, num_enabled_before);
+    uint8_t updates_left = HNF_MAX_COEFF_UPDATES;
+    if (_next_update >= _num_enabled_filters) {
+        _next_update = 0;
+    }
+    int16_t first_deferred = -1;
+
+    for (uint8_t n = 0; n < _num_enabled_filters; n++) {
+        const uint8_t i = (_next_update + n) % _num_enabled_filters;
+        NotchFilterBase &f = _filters[i];
+        const float target_freq_hz = _target_freq_hz[i];
+
+        // new notches are always calculated, running notches only if
+        // they have moved enough and there is time this update
+        if (i < num_enabled_before && f.initialised && is_equal(f._sample_freq_hz, _sample_freq_hz)) {
+            if (fabsF(target_freq_hz - f._center_freq_hz) <= target_freq_hz * HNF_FREQ_TOLERANCE) {
+                continue;
             }
+            if (updates_left == 0) {
+                if (first_deferred < 0) {
+                    first_deferred = i;
+                }
+                continue;
+            }
+            updates_left--;
+        }
+        f.init_with_A_and_Q(_sample_freq_hz, target_freq_hz, _A, _Q);
+
+        NotchCoeffs &c = _coeffs[i];
+        if (f.initialised) {
+            c.b0 = f.b0 * f.a0_inv;
+            c.b1 = f.b1 * f.a0_inv;
+            c.b2 = f.b2 * f.a0_inv;
+            c.a2 = f.a2 * f.a0_inv;
+        } else {
+            // pass the sample through unchanged, and start from the
+            // steady state once the notch is initialised
+            c.b0 = 1;
+            c.b1 = 0;
+            c.b2 = 0;
+            c.a2 = 0;
+            f.need_reset = true;
+        }
+        // a pass through notch needs no reseeding until it is
+        // initialised, apply() then clears need_reset
+        if (f.initialised && f.need_reset) {
+            num_valid = MIN(num_valid, i);
         }
     }
+    _num_valid_states = num_valid;
+    _next_update = first_deferred < 0 ? 0 : first_deferred;
 }
 
 /*
@@ -297,10 +413,43 @@ T HarmonicNotchFilter<T>::apply(const T &sample)
         return sample;
     }
 
-    T output = sample;
-    for (uint8_t i = 0; i < _num_enabled_filters; i++) {
-        output = _filters[i].apply(output);
+    float x[_axes];
+    memcpy(x, &sample, sizeof(x));
+
+    const uint8_t num_valid = MIN(_num_valid_states, _num_enabled_filters);
+    uint8_t i;
+    for (i = 0; i < num_valid; i++) {
+        const NotchCoeffs &c = _coeffs[i];
+        float *x1 = &_state[i * 4 * _axes];
+        float *x2 = x1 + _axes;
+        float *y1 = x2 + _axes;
+        float *y2 = y1 + _axes;
+        for (uint8_t a = 0; a < _axes; a++) {
+            const float in = x[a];
+            const float out = c.b0 * in + c.b1 * (x1[a] - y1[a]) + c.b2 * x2[a] - c.a2 * y2[a];
+            x2[a] = x1[a];
+            x1[a] = in;
+            y2[a] = y1[a];
+            y1[a] = out;
+            x[a] = out;
+        }
+    }
+
+    // the remaining notches pass this sample through and start from
+    // the steady state for it, so a reset causes no glitch
+    for (; i < _num_enabled_filters; i++) {
+        float *s = &_state[i * 4 * _axes];
+        for (uint8_t a = 0; a < 4 * _axes; a++) {
+            s[a] = x[a % _axes];
+        }
+        if (_filters[i].initialised) {
+            _filters[i].need_reset = false;
+        }
     }
+    _num_valid_states = _num_enabled_filters;
+
+    T output;
+    memcpy(&output, x, sizeof(x));
     return output;
 }
 
@@ -314,6 +463,7 @@ void HarmonicNotchFilter<T>::reset()
         return;
     }
 
+    _num_valid_states = 0;
     for (uint8_t i = 0; i < _num_filters; i++) {
         _filters[i].reset();
     }
@@ -45,8 +45,33 @@ public:
     void reset();
 
 private:
-    // underlying bank of notch filters
-    NotchFilter<T>*  _filters;
+    // recalculate coefficients of notches that have moved and copy
+    // them into the filter bank
+    void update_coeffs(uint8_t num_enabled_before);
+
+    // per-notch front-end, tracking center frequency and coefficients
+    NotchFilterBase* _filters;
+    // target center frequency of each enabled notch
+    float* _target_freq_hz;
+    // notch to carry on from in the next update_coeffs()
+    uint8_t _next_update;
+
+    /*
+      the filter bank that apply() runs over. Coefficients are
+      normalised by a0 and packed per notch. Each notch keeps its
+      delayed inputs and outputs (direct form I, which behaves well as
+      the center frequency moves) as arrays over the axes, so the
+      inner loop over axes is contiguous
+     */
+    static constexpr uint8_t _axes = sizeof(T) / sizeof(float);
+    struct NotchCoeffs {
+        float b0, b1, b2, a2;   // a1 equals b1 for a notch
+    };
+    NotchCoeffs* _coeffs;
+    float* _state;
+    // number of enabled notches with a valid state, notches beyond
+    // this are started from the steady state for the next sample
+    uint8_t _num_valid_states;
     // sample frequency for each filter
     float _sample_freq_hz;
     // base double notch bandwidth for each filter
@@ -24,11 +24,26 @@ const static float NOTCH_MAX_SLEW       = 0.05f;
 const static float NOTCH_MAX_SLEW_LOWER = 1.0f - NOTCH_MAX_SLEW;
 const static float NOTCH_MAX_SLEW_UPPER = 1.0f / NOTCH_MAX_SLEW_LOWER;
 
+/*
+  sine and cosine of omega for 0 <= omega <= pi, using polynomials
+  around pi/2 which are accurate to within 2e-7. This is much
+  cheaper than sinf() and cosf() on boards without a hardware libm,
+  and is called for every notch each time its center frequency moves
+ */
+static void notch_sin_cos(float omega, float &sin_omega, float &cos_omega)
+{
+    const float x = omega - M_PI_2;
+    const float x2 = x * x;
+    // sin(omega) = cos(x)
+    sin_omega = 1.0f + x2 * (-1.0f/2 + x2 * (1.0f/24 + x2 * (-1.0f/720 + x2 * (1.0f/40320 + x2 * (-1.0f/3628800 + x2 * (1.0f/479001600))))));
+    // cos(omega) = -sin(x)
+    cos_omega = -x * (1.0f + x2 * (-1.0f/6 + x2 * (1.0f/120 + x2 * (-1.0f/5040 + x2 * (1.0f/362880 + x2 * (-1.0f/39916800))))));
+}
+
 /*
    calculate the attenuation and quality factors of the filter
  */
-template <class T>
-void NotchFilter<T>::calculate_A_and_Q(float center_freq_hz, float bandwidth_hz, float attenuation_dB, float& A, float& Q) {
+void NotchFilterBase::calculate_A_and_Q(float center_freq_hz, float bandwidth_hz, float attenuation_dB, float& A, float& Q) {
     A = powf(10, -attenuation_dB / 40.0f);
     if (center_freq_hz > 0.5 * bandwidth_hz) {
         const float octaves = log2f(center_freq_hz / (center_freq_hz - bandwidth_hz / 2.0f)) * 2.0f;
@@ -41,8 +56,7 @@ void NotchFilter<T>::calculate_A_and_Q(float center_freq_hz, float bandwidth_hz,
 /*
   initialise filter
  */
-template <class T>
-void NotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
+void NotchFilterBase::init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
 {
     // check center frequency is in the allowable range
     if ((center_freq_hz > 0.5 * bandwidth_hz) && (center_freq_hz < 0.5 * sample_freq_hz)) {
@@ -55,8 +69,7 @@ void NotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, float band
     }
 }
 
-template <class T>
-void NotchFilter<T>::init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q)
+void NotchFilterBase::init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q)
 {
     // don't update if no updates required
     if (initialised && is_equal(center_freq_hz, _center_freq_hz) && is_equal(sample_freq_hz, _sample_freq_hz)) {
@@ -73,9 +86,11 @@ void NotchFilter<T>::init_with_A_and_Q(float sample_freq_hz, float center_freq_h
 
     if ((new_center_freq > 0.0) && (new_center_freq < 0.5 * sample_freq_hz) && (Q > 0.0)) {
         float omega = 2.0 * M_PI * new_center_freq / sample_freq_hz;
-        float alpha = sinf(omega) / (2 * Q);
+        float sin_omega, cos_omega;
+        notch_sin_cos(omega, sin_omega, cos_omega);
+        float alpha = sin_omega / (2 * Q);
         b0 =  1.0 + alpha*sq(A);
-        b1 = -2.0 * cosf(omega);
+        b1 = -2.0 * cos_omega;
         b2 =  1.0 - alpha*sq(A);
         a0_inv =  1.0/(1.0 + alpha);
         a1 = b1;
@@ -115,8 +130,7 @@ T NotchFilter<T>::apply(const T &sample)
     return output;
 }
 
-template <class T>
-void NotchFilter<T>::reset()
+void NotchFilterBase::reset()
 {
     need_reset = true;
 }
@@ -26,23 +26,35 @@
 #include <AP_Param/AP_Param.h>
 
 
-template <class T>
-class NotchFilter {
+/*
+  notch filter coefficients and center frequency tracking, independent
+  of the sample type. HarmonicNotchFilter uses this as the front-end
+  for each notch in its filter bank
+ */
+class NotchFilterBase {
 public:
     // set parameters
     void init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
     void init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q);
-    T apply(const T &sample);
     void reset();
 
     // calculate attenuation and quality from provided center frequency and bandwidth
     static void calculate_A_and_Q(float center_freq_hz, float bandwidth_hz, float attenuation_dB, float& A, float& Q); 
 
 protected:
+    template <class T> friend class HarmonicNotchFilter;
 
     bool initialised, need_reset;
     float b0, b1, b2, a1, a2, a0_inv;
     float _center_freq_hz, _sample_freq_hz;
+};
+
+template <class T>
+class NotchFilter : public NotchFilterBase {
+public:
+    T apply(const T &sample);
+
+protected:
     T ntchsig, ntchsig1, ntchsig2, signal2, signal1;
 };
 
@@ -0,0 +1,124 @@
+#include <AP_gbenchmark.h>
+
+#include <Filter/HarmonicNotchFilter.h>
+#include <Filter/LowPassFilter2p.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  the gyro filter chain in AP_InertialSensor_Backend::apply_gyro_filters()
+  for a board with 3 IMUs and 2 harmonic notches, each with 4 harmonics
+  and double notches, at 2kHz
+ */
+static const uint8_t num_imus = 3;
+static const uint8_t num_notches = 2;
+static const uint8_t harmonics = 0x0F;
+static const uint8_t composite_notches = 2;
+static const float sample_rate_hz = 2000;
+static const float notch_freq_hz[num_notches] { 80, 130 };
+
+// a gyro sample with noise at the motor frequency and its harmonics
+static Vector3f gyro_sample(uint32_t i)
+{
+    const float t = i / sample_rate_hz;
+    const float noise = sinf(2 * M_PI * 82 * t) + 0.5 * sinf(2 * M_PI * 164 * t);
+    return Vector3f(0.1 + noise, -0.2 + noise, 0.05 + noise);
+}
+
+static void BM_GyroFilterChain(benchmark::State& state)
+{
+    static HarmonicNotchFilterVector3f notch[num_notches][num_imus];
+    static LowPassFilter2pVector3f lpf[num_imus];
+    for (uint8_t n=0; n<num_notches; n++) {
+        for (uint8_t i=0; i<num_imus; i++) {
+            notch[n][i].allocate_filters(1, harmonics, composite_notches);
+            notch[n][i].init(sample_rate_hz, notch_freq_hz[n], notch_freq_hz[n]/2, 40);
+        }
+    }
+    for (uint8_t i=0; i<num_imus; i++) {
+        lpf[i].set_cutoff_frequency(sample_rate_hz, 60);
+    }
+
+    uint32_t s = 0;
+    while (state.KeepRunning()) {
+        const Vector3f gyro = gyro_sample(s++);
+        for (uint8_t i=0; i<num_imus; i++) {
+            Vector3f gyro_filtered = gyro;
+            for (uint8_t n=0; n<num_notches; n++) {
+                gyro_filtered = notch[n][i].apply(gyro_filtered);
+            }
+            gyro_filtered = lpf[i].apply(gyro_filtered);
+            gbenchmark_escape(&gyro_filtered);
+        }
+    }
+}
+
+// the same chain with one NotchFilter per notch applied in turn, as
+// HarmonicNotchFilter did before it used a filter bank, for comparison
+static void BM_GyroFilterChainNotchFilters(benchmark::State& state)
+{
+    const uint8_t notches_per_filter = __builtin_popcount(harmonics) * composite_notches;
+    static NotchFilterVector3f notch[num_notches][num_imus][8];
+    static LowPassFilter2pVector3f lpf[num_imus];
+    for (uint8_t n=0; n<num_notches; n++) {
+        const float bandwidth_hz = notch_freq_hz[n]/2;
+        const float spread = bandwidth_hz / (32 * notch_freq_hz[n]);
+        float A, Q;
+        NotchFilterBase::calculate_A_and_Q(notch_freq_hz[n], bandwidth_hz / composite_notches, 40, A, Q);
+        for (uint8_t i=0; i<num_imus; i++) {
+            for (uint8_t h=0; h<notches_per_filter; h++) {
+                const float center_hz = notch_freq_hz[n] * (h/2 + 1) * ((h & 1) ? 1 + spread : 1 - spread);
+                notch[n][i][h].init_with_A_and_Q(sample_rate_hz, center_hz, A, Q);
+            }
+        }
+    }
+    for (uint8_t i=0; i<num_imus; i++) {
+        lpf[i].set_cutoff_frequency(sample_rate_hz, 60);
+    }
+
+    uint32_t s = 0;
+    while (state.KeepRunning()) {
+        const Vector3f gyro = gyro_sample(s++);
+        for (uint8_t i=0; i<num_imus; i++) {
+            Vector3f gyro_filtered = gyro;
+            for (uint8_t n=0; n<num_notches; n++) {
+                for (uint8_t h=0; h<notches_per_filter; h++) {
+                    gyro_filtered = notch[n][i][h].apply(gyro_filtered);
+                }
+            }
+            gyro_filtered = lpf[i].apply(gyro_filtered);
+            gbenchmark_escape(&gyro_filtered);
+        }
+    }
+}
+
+/*
+  per-motor ESC telemetry tracking on a quad with 3 harmonics and
+  double notches, 24 notches updated every loop. Arg 0 has telemetry
+  jitter below the update tolerance, arg 1 has motors changing speed
+ */
+static void BM_NotchUpdateESC(benchmark::State& state)
+{
+    const uint8_t num_motors = 4;
+    static HarmonicNotchFilterVector3f notch;
+    notch.allocate_filters(num_motors, 0x07, composite_notches);
+    notch.init(sample_rate_hz, notch_freq_hz[0], notch_freq_hz[0]/2, 40);
+
+    const float step = state.range(0) ? 1e-2 : 1e-5;
+    float freqs[num_motors];
+    uint32_t s = 0;
+    while (state.KeepRunning()) {
+        for (uint8_t m=0; m<num_motors; m++) {
+            freqs[m] = notch_freq_hz[0] * (1 + step * ((s + m) & 3));
+        }
+        s++;
+        notch.update(num_motors, freqs);
+        gbenchmark_escape(&notch);
+    }
+}
+
+BENCHMARK(BM_GyroFilterChain);
+BENCHMARK(BM_GyroFilterChainNotchFilters);
+BENCHMARK(BM_NotchUpdateESC)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
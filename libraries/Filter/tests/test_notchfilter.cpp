@@ -156,4 +156,64 @@ TEST(NotchFilterTest, HarmonicNotchTest)
     EXPECT_NEAR(integrals[9].get_lag_degrees(10), 112.23, 0.5);
 }
 
+/*
+  test that the filter bank in a harmonic notch gives the same output
+  as the equivalent chain of notch filters, including across a change
+  of center frequency
+ */
+TEST(NotchFilterTest, HarmonicNotchBankTest)
+{
+    const float rate_hz = 2000;
+    const float base_freq = 80;
+    const float bandwidth = base_freq/2;
+    const float attenuation_dB = 40;
+    const uint8_t num_harmonics = 4;
+
+    HarmonicNotchFilter<Vector3f> harmonic;
+    harmonic.allocate_filters(1, (1U<<num_harmonics)-1, 2);
+    harmonic.init(rate_hz, base_freq, bandwidth, attenuation_dB);
+
+    NotchFilter<Vector3f> chain[num_harmonics*2] {};
+    float A, Q;
+    NotchFilterBase::calculate_A_and_Q(base_freq, bandwidth/2, attenuation_dB, A, Q);
+    const float spread = bandwidth / (32 * base_freq);
+    auto init_chain = [&](float freq) {
+        for (uint8_t h=0; h<num_harmonics; h++) {
+            chain[2*h].init_with_A_and_Q(rate_hz, freq*(h+1)*(1-spread), A, Q);
+            chain[2*h+1].init_with_A_and_Q(rate_hz, freq*(h+1)*(1+spread), A, Q);
+        }
+    };
+    init_chain(base_freq);
+    for (auto &n : chain) {
+        n.reset();
+    }
+
+    for (uint32_t s=0; s<10000; s++) {
+        if (s == 5000) {
+            harmonic.update(85);
+            init_chain(85);
+        }
+        const float t = s / rate_hz;
+        const Vector3f sample(sinf(2*M_PI*83*t) + 0.3, sinf(2*M_PI*161*t), 0.5*cosf(2*M_PI*17*t));
+        Vector3f expected = sample;
+        for (auto &n : chain) {
+            expected = n.apply(expected);
+        }
+        const Vector3f v = harmonic.apply(sample);
+        EXPECT_NEAR(v.x, expected.x, 1.0e-4);
+        EXPECT_NEAR(v.y, expected.y, 1.0e-4);
+        EXPECT_NEAR(v.z, expected.z, 1.0e-4);
+    }
+
+    // a reset gives no glitch with constant input
+    harmonic.reset();
+    const Vector3f const_sample(-0.512, 0.2, 0.1);
+    for (uint32_t i=0; i<100; i++) {
+        const Vector3f v = harmonic.apply(const_sample);
+        EXPECT_NEAR(v.x, const_sample.x, 1.0e-5);
+        EXPECT_NEAR(v.y, const_sample.y, 1.0e-5);
+        EXPECT_NEAR(v.z, const_sample.z, 1.0e-5);
+    }
+}
+
 AP_GTEST_MAIN()
@@ -228,6 +228,11 @@ public:
     // this is called when we discover we'd like to send something but can't:
     void out_of_space_to_send() { out_of_space_to_send_count++; }
 
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+    // this is called with the number of bytes written to the port
+    void count_tx_bytes(uint16_t n) { stream_bw.tx_bytes += n; }
+#endif
+
     void send_mission_ack(const mavlink_message_t &msg,
                           MAV_MISSION_TYPE mission_type,
                           MAV_MISSION_RESULT result) const {
@@ -824,6 +829,12 @@ private:
         Bitmask<MSG_LAST> ap_message_ids;
         uint16_t interval_ms;
         uint16_t last_sent_ms; // from AP_HAL::millis16()
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+        uint16_t scaled_interval_ms; // interval_ms stretched to fit the stream bandwidth
+        uint16_t pass_bytes; // bytes sent so far while sending this bucket
+        uint16_t bytes_per_pass; // bytes sent by the last complete send of this bucket
+        uint16_t pass_count; // complete sends since stats were last logged
+#endif
     };
     deferred_message_bucket_t deferred_message_bucket[10];
     static const uint8_t no_bucket_to_send = -1;
@@ -835,6 +846,30 @@ private:
     void find_next_bucket_to_send(uint16_t now16_ms);
     void remove_message_from_bucket(int8_t bucket, ap_message id);
 
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+    // token bucket limiting the bytes streamed messages may use
+    struct {
+        uint32_t tx_bytes; // total bytes written to the port
+        uint32_t window_start_ms; // start of the drain rate measurement
+        uint32_t window_tx_bytes; // tx_bytes at window_start_ms
+        uint32_t window_txspace; // txspace at window_start_ms
+        uint32_t window_min_txspace; // lowest txspace seen in the window
+        uint32_t max_txspace; // highest txspace ever seen, roughly the buffer size
+        uint32_t drain_bps; // estimated bytes per second the link drains
+        uint32_t budget_bps; // bytes per second allocated to streams
+        bool limiting; // true if streams are being fitted to drain_bps
+        uint8_t clear_windows; // windows since the buffer last backed up
+        float tokens; // bytes streamed messages may send now
+        uint32_t last_refill_us;
+        uint32_t last_allocate_ms;
+        uint32_t stats_start_ms; // start of the achieved rate measurement
+    } stream_bw;
+    void update_stream_bandwidth();
+    void allocate_stream_bandwidth();
+    uint8_t stream_weight(const deferred_message_bucket_t &bucket) const;
+    void log_stream_rates();
+#endif
+
     // bitmask of IDs the code has spontaneously decided it wants to
     // send out.  Examples include HEARTBEAT (gcs_send_heartbeat)
     Bitmask<MSG_LAST> pushed_ap_message_ids;
@@ -987,6 +1022,18 @@ private:
         int16_t current_session;
         uint32_t last_send_ms;
         uint8_t need_banner_send_mask;
+
+        // read-ahead of the open file, see ftp_read()
+        uint8_t *readahead;
+        uint32_t readahead_offset;
+        uint16_t readahead_len;
+        bool use_readahead;
+
+        // burst read pacing on links without flow control, adapted
+        // to the losses the GCS reports by re-reading offsets
+        uint32_t burst_delay_us;
+        uint32_t burst_end_offset; // end of the data sent by bursts in this session
+        uint16_t burst_clean_count; // packets sent since the last loss
     };
     static struct ftp_state ftp;
 
@@ -999,6 +1046,10 @@ private:
     bool send_ftp_reply(const pending_ftp &reply);
     void ftp_worker(void);
     void ftp_push_replies(pending_ftp &reply);
+    static ssize_t ftp_read(uint32_t offset, uint8_t *dest, uint16_t len);
+    bool ftp_burst_read(const pending_ftp &request, pending_ftp &reply);
+    void ftp_resend(pending_ftp &msg);
+    static void ftp_burst_loss(void);
 
     void send_distance_sensor(const class AP_RangeFinder_Backend *sensor, const uint8_t instance) const;
 
@@ -1296,6 +1347,9 @@ private:
     // true if update_send has ever been called:
     bool update_send_has_been_called;
 
+    // time the routing table was last logged
+    uint32_t last_routing_log_ms;
+
     // handle passthru between two UARTs
     struct {
         bool enabled;
@@ -919,131 +919,180 @@ void GCS_MAVLINK::handle_mission_item(const mavlink_message_t &msg)
     prot->handle_mission_item(msg, mission_item_int);
 }
 
-ap_message GCS_MAVLINK::mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const
-{
-    // MSG_NEXT_MISSION_REQUEST doesn't correspond to a mavlink message directly.
-    // It is used to request the next waypoint after receiving one.
-
-    // MSG_NEXT_PARAM doesn't correspond to a mavlink message directly.
-    // It is used to send the next parameter in a stream after sending one
-
-    // MSG_NAMED_FLOAT messages can't really be "streamed"...
-
-    static const struct {
-        uint32_t mavlink_id;
-        ap_message msg_id;
-    } map[] {
-        { MAVLINK_MSG_ID_HEARTBEAT,             MSG_HEARTBEAT},
-        { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE},
-        { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,   MSG_ATTITUDE_QUATERNION},
-        { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION},
-        { MAVLINK_MSG_ID_HOME_POSITION,         MSG_HOME},
-        { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,     MSG_ORIGIN},
-        { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS},
-        { MAVLINK_MSG_ID_POWER_STATUS,          MSG_POWER_STATUS},
+// map from mavlink message ids to ap_message ids.
+//
+// MSG_NEXT_MISSION_REQUEST doesn't correspond to a mavlink message directly.
+// It is used to request the next waypoint after receiving one.
+
+// MSG_NEXT_PARAM doesn't correspond to a mavlink message directly.
+// It is used to send the next parameter in a stream after sending one
+
+// MSG_NAMED_FLOAT messages can't really be "streamed"...
+
+static const struct {
+    uint32_t mavlink_id;
+    ap_message msg_id;
+} ap_message_map[] {
+    { MAVLINK_MSG_ID_HEARTBEAT,             MSG_HEARTBEAT},
+    { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE},
+    { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,   MSG_ATTITUDE_QUATERNION},
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION},
+    { MAVLINK_MSG_ID_HOME_POSITION,         MSG_HOME},
+    { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,     MSG_ORIGIN},
+    { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS},
+    { MAVLINK_MSG_ID_POWER_STATUS,          MSG_POWER_STATUS},
 #if HAL_WITH_MCU_MONITORING
-        { MAVLINK_MSG_ID_MCU_STATUS,            MSG_MCU_STATUS},
-#endif
-        { MAVLINK_MSG_ID_MEMINFO,               MSG_MEMINFO},
-        { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT},
-        { MAVLINK_MSG_ID_MISSION_CURRENT,       MSG_CURRENT_WAYPOINT},
-        { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD},
-        { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW},
-        { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS},
-        { MAVLINK_MSG_ID_RC_CHANNELS_RAW,       MSG_RC_CHANNELS_RAW},
-        { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU},
-        { MAVLINK_MSG_ID_SCALED_IMU,            MSG_SCALED_IMU},
-        { MAVLINK_MSG_ID_SCALED_IMU2,           MSG_SCALED_IMU2},
-        { MAVLINK_MSG_ID_SCALED_IMU3,           MSG_SCALED_IMU3},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE,       MSG_SCALED_PRESSURE},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE2,      MSG_SCALED_PRESSURE2},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE3,      MSG_SCALED_PRESSURE3},
-        { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW},
-        { MAVLINK_MSG_ID_GPS_RTK,               MSG_GPS_RTK},
+    { MAVLINK_MSG_ID_MCU_STATUS,            MSG_MCU_STATUS},
+#endif
+    { MAVLINK_MSG_ID_MEMINFO,               MSG_MEMINFO},
+    { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT},
+    { MAVLINK_MSG_ID_MISSION_CURRENT,       MSG_CURRENT_WAYPOINT},
+    { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD},
+    { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW},
+    { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS},
+    { MAVLINK_MSG_ID_RC_CHANNELS_RAW,       MSG_RC_CHANNELS_RAW},
+    { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU},
+    { MAVLINK_MSG_ID_SCALED_IMU,            MSG_SCALED_IMU},
+    { MAVLINK_MSG_ID_SCALED_IMU2,           MSG_SCALED_IMU2},
+    { MAVLINK_MSG_ID_SCALED_IMU3,           MSG_SCALED_IMU3},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE,       MSG_SCALED_PRESSURE},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE2,      MSG_SCALED_PRESSURE2},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE3,      MSG_SCALED_PRESSURE3},
+    { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW},
+    { MAVLINK_MSG_ID_GPS_RTK,               MSG_GPS_RTK},
 #if GPS_MAX_RECEIVERS > 1
-        { MAVLINK_MSG_ID_GPS2_RAW,              MSG_GPS2_RAW},
-        { MAVLINK_MSG_ID_GPS2_RTK,              MSG_GPS2_RTK},
-#endif
-        { MAVLINK_MSG_ID_SYSTEM_TIME,           MSG_SYSTEM_TIME},
-        { MAVLINK_MSG_ID_RC_CHANNELS_SCALED,    MSG_SERVO_OUT},
-        { MAVLINK_MSG_ID_PARAM_VALUE,           MSG_NEXT_PARAM},
-        { MAVLINK_MSG_ID_FENCE_STATUS,          MSG_FENCE_STATUS},
-        { MAVLINK_MSG_ID_AHRS,                  MSG_AHRS},
+    { MAVLINK_MSG_ID_GPS2_RAW,              MSG_GPS2_RAW},
+    { MAVLINK_MSG_ID_GPS2_RTK,              MSG_GPS2_RTK},
+#endif
+    { MAVLINK_MSG_ID_SYSTEM_TIME,           MSG_SYSTEM_TIME},
+    { MAVLINK_MSG_ID_RC_CHANNELS_SCALED,    MSG_SERVO_OUT},
+    { MAVLINK_MSG_ID_PARAM_VALUE,           MSG_NEXT_PARAM},
+    { MAVLINK_MSG_ID_FENCE_STATUS,          MSG_FENCE_STATUS},
+    { MAVLINK_MSG_ID_AHRS,                  MSG_AHRS},
 #if AP_SIM_ENABLED
-        { MAVLINK_MSG_ID_SIMSTATE,              MSG_SIMSTATE},
-        { MAVLINK_MSG_ID_SIM_STATE,             MSG_SIM_STATE},
-#endif
-        { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2},
-        { MAVLINK_MSG_ID_HWSTATUS,              MSG_HWSTATUS},
-        { MAVLINK_MSG_ID_WIND,                  MSG_WIND},
-        { MAVLINK_MSG_ID_RANGEFINDER,           MSG_RANGEFINDER},
-        { MAVLINK_MSG_ID_DISTANCE_SENSOR,       MSG_DISTANCE_SENSOR},
-            // request also does report:
-        { MAVLINK_MSG_ID_TERRAIN_REQUEST,       MSG_TERRAIN},
+    { MAVLINK_MSG_ID_SIMSTATE,              MSG_SIMSTATE},
+    { MAVLINK_MSG_ID_SIM_STATE,             MSG_SIM_STATE},
+#endif
+    { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2},
+    { MAVLINK_MSG_ID_HWSTATUS,              MSG_HWSTATUS},
+    { MAVLINK_MSG_ID_WIND,                  MSG_WIND},
+    { MAVLINK_MSG_ID_RANGEFINDER,           MSG_RANGEFINDER},
+    { MAVLINK_MSG_ID_DISTANCE_SENSOR,       MSG_DISTANCE_SENSOR},
+        // request also does report:
+    { MAVLINK_MSG_ID_TERRAIN_REQUEST,       MSG_TERRAIN},
 #if AP_MAVLINK_BATTERY2_ENABLED
-        { MAVLINK_MSG_ID_BATTERY2,              MSG_BATTERY2},
+    { MAVLINK_MSG_ID_BATTERY2,              MSG_BATTERY2},
 #endif
-        { MAVLINK_MSG_ID_CAMERA_FEEDBACK,       MSG_CAMERA_FEEDBACK},
-        { MAVLINK_MSG_ID_CAMERA_INFORMATION,    MSG_CAMERA_INFORMATION},
-        { MAVLINK_MSG_ID_CAMERA_SETTINGS,       MSG_CAMERA_SETTINGS},
+    { MAVLINK_MSG_ID_CAMERA_FEEDBACK,       MSG_CAMERA_FEEDBACK},
+    { MAVLINK_MSG_ID_CAMERA_INFORMATION,    MSG_CAMERA_INFORMATION},
+    { MAVLINK_MSG_ID_CAMERA_SETTINGS,       MSG_CAMERA_SETTINGS},
 #if HAL_MOUNT_ENABLED
-        { MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, MSG_GIMBAL_DEVICE_ATTITUDE_STATUS},
-        { MAVLINK_MSG_ID_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE, MSG_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE},
-        { MAVLINK_MSG_ID_GIMBAL_MANAGER_INFORMATION, MSG_GIMBAL_MANAGER_INFORMATION},
-        { MAVLINK_MSG_ID_GIMBAL_MANAGER_STATUS, MSG_GIMBAL_MANAGER_STATUS},
+    { MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, MSG_GIMBAL_DEVICE_ATTITUDE_STATUS},
+    { MAVLINK_MSG_ID_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE, MSG_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE},
+    { MAVLINK_MSG_ID_GIMBAL_MANAGER_INFORMATION, MSG_GIMBAL_MANAGER_INFORMATION},
+    { MAVLINK_MSG_ID_GIMBAL_MANAGER_STATUS, MSG_GIMBAL_MANAGER_STATUS},
 #endif
 #if AP_OPTICALFLOW_ENABLED
-        { MAVLINK_MSG_ID_OPTICAL_FLOW,          MSG_OPTICAL_FLOW},
-#endif
-        { MAVLINK_MSG_ID_MAG_CAL_PROGRESS,      MSG_MAG_CAL_PROGRESS},
-        { MAVLINK_MSG_ID_MAG_CAL_REPORT,        MSG_MAG_CAL_REPORT},
-        { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT},
-        { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    MSG_LOCAL_POSITION},
-        { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING},
-        { MAVLINK_MSG_ID_VIBRATION,             MSG_VIBRATION},
+    { MAVLINK_MSG_ID_OPTICAL_FLOW,          MSG_OPTICAL_FLOW},
+#endif
+    { MAVLINK_MSG_ID_MAG_CAL_PROGRESS,      MSG_MAG_CAL_PROGRESS},
+    { MAVLINK_MSG_ID_MAG_CAL_REPORT,        MSG_MAG_CAL_REPORT},
+    { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT},
+    { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    MSG_LOCAL_POSITION},
+    { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING},
+    { MAVLINK_MSG_ID_VIBRATION,             MSG_VIBRATION},
 #if AP_RPM_ENABLED
-        { MAVLINK_MSG_ID_RPM,                   MSG_RPM},
-#endif
-        { MAVLINK_MSG_ID_MISSION_ITEM_REACHED,  MSG_MISSION_ITEM_REACHED},
-        { MAVLINK_MSG_ID_ATTITUDE_TARGET,       MSG_ATTITUDE_TARGET},
-        { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,  MSG_POSITION_TARGET_GLOBAL_INT},
-        { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,  MSG_POSITION_TARGET_LOCAL_NED},
-        { MAVLINK_MSG_ID_ADSB_VEHICLE,          MSG_ADSB_VEHICLE},
-        { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS},
-        { MAVLINK_MSG_ID_AOA_SSA,               MSG_AOA_SSA},
-        { MAVLINK_MSG_ID_DEEPSTALL,             MSG_LANDING},
-        { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    MSG_EXTENDED_SYS_STATE},
-        { MAVLINK_MSG_ID_AUTOPILOT_VERSION,     MSG_AUTOPILOT_VERSION},
+    { MAVLINK_MSG_ID_RPM,                   MSG_RPM},
+#endif
+    { MAVLINK_MSG_ID_MISSION_ITEM_REACHED,  MSG_MISSION_ITEM_REACHED},
+    { MAVLINK_MSG_ID_ATTITUDE_TARGET,       MSG_ATTITUDE_TARGET},
+    { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,  MSG_POSITION_TARGET_GLOBAL_INT},
+    { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,  MSG_POSITION_TARGET_LOCAL_NED},
+    { MAVLINK_MSG_ID_ADSB_VEHICLE,          MSG_ADSB_VEHICLE},
+    { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS},
+    { MAVLINK_MSG_ID_AOA_SSA,               MSG_AOA_SSA},
+    { MAVLINK_MSG_ID_DEEPSTALL,             MSG_LANDING},
+    { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    MSG_EXTENDED_SYS_STATE},
+    { MAVLINK_MSG_ID_AUTOPILOT_VERSION,     MSG_AUTOPILOT_VERSION},
 #if HAL_EFI_ENABLED
-        { MAVLINK_MSG_ID_EFI_STATUS,            MSG_EFI_STATUS},
+    { MAVLINK_MSG_ID_EFI_STATUS,            MSG_EFI_STATUS},
 #endif
 #if HAL_GENERATOR_ENABLED
-        { MAVLINK_MSG_ID_GENERATOR_STATUS,      MSG_GENERATOR_STATUS},
+    { MAVLINK_MSG_ID_GENERATOR_STATUS,      MSG_GENERATOR_STATUS},
 #endif
-        { MAVLINK_MSG_ID_WINCH_STATUS,          MSG_WINCH_STATUS},
+    { MAVLINK_MSG_ID_WINCH_STATUS,          MSG_WINCH_STATUS},
 #if HAL_WITH_ESC_TELEM
-        { MAVLINK_MSG_ID_ESC_TELEMETRY_1_TO_4,  MSG_ESC_TELEMETRY},
+    { MAVLINK_MSG_ID_ESC_TELEMETRY_1_TO_4,  MSG_ESC_TELEMETRY},
 #endif
 #if APM_BUILD_TYPE(APM_BUILD_Rover)
-        { MAVLINK_MSG_ID_WATER_DEPTH,           MSG_WATER_DEPTH},
+    { MAVLINK_MSG_ID_WATER_DEPTH,           MSG_WATER_DEPTH},
 #endif
 #if HAL_HIGH_LATENCY2_ENABLED
-        { MAVLINK_MSG_ID_HIGH_LATENCY2,         MSG_HIGH_LATENCY2},
+    { MAVLINK_MSG_ID_HIGH_LATENCY2,         MSG_HIGH_LATENCY2},
 #endif
 #if AP_AIS_ENABLED
-        { MAVLINK_MSG_ID_AIS_VESSEL,            MSG_AIS_VESSEL},
+    { MAVLINK_MSG_ID_AIS_VESSEL,            MSG_AIS_VESSEL},
 #endif
 #if HAL_ADSB_ENABLED
-        { MAVLINK_MSG_ID_UAVIONIX_ADSB_OUT_STATUS, MSG_UAVIONIX_ADSB_OUT_STATUS},
+    { MAVLINK_MSG_ID_UAVIONIX_ADSB_OUT_STATUS, MSG_UAVIONIX_ADSB_OUT_STATUS},
 #endif
-            };
+};
+
+static_assert(MSG_LAST < UINT8_MAX, "ap_message must fit in a uint8_t");
+
+/*
+  direct index from mavlink ids to ap_message ids, built once at
+  startup from ap_message_map. Almost all the mapped mavlink ids are
+  below 256; the few above that are kept in a short list
+ */
+class APMessageIndex {
+public:
+    APMessageIndex() {
+        memset(small_ids, MSG_LAST, sizeof(small_ids));
+        for (const auto &entry : ap_message_map) {
+            if (entry.mavlink_id < ARRAY_SIZE(small_ids)) {
+                if (small_ids[entry.mavlink_id] == MSG_LAST) {
+                    small_ids[entry.mavlink_id] = entry.msg_id;
+                }
+            } else if (num_large_ids < ARRAY_SIZE(large_ids)) {
+                large_ids[num_large_ids++] = &entry - &ap_message_map[0];
+            } else {
+                large_ids_overflow = true;
+            }
+        }
+    }
 
-    for (uint8_t i=0; i<ARRAY_SIZE(map); i++) {
-        if (map[i].mavlink_id == mavlink_id) {
-            return map[i].msg_id;
+    ap_message find(const uint32_t mavlink_id) const {
+        if (mavlink_id < ARRAY_SIZE(small_ids)) {
+            return (ap_message)small_ids[mavlink_id];
+        }
+        if (large_ids_overflow) {
+            for (const auto &entry : ap_message_map) {
+                if (entry.mavlink_id == mavlink_id) {
+                    return entry.msg_id;
+                }
+            }
+            return MSG_LAST;
         }
+        for (uint8_t i=0; i<num_large_ids; i++) {
+            if (ap_message_map[large_ids[i]].mavlink_id == mavlink_id) {
+                return ap_message_map[large_ids[i]].msg_id;
+            }
+        }
+        return MSG_LAST;
     }
-    return MSG_LAST;
+
+private:
+    uint8_t small_ids[256];
+    uint8_t large_ids[16];
+    uint8_t num_large_ids = 0;
+    bool large_ids_overflow = false;
+};
+static const APMessageIndex ap_message_index;
+
+ap_message GCS_MAVLINK::mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const
+{
+    return ap_message_index.find(mavlink_id);
 }
 
 bool GCS_MAVLINK::set_mavlink_message_id_interval(const uint32_t mavlink_id,
@@ -1077,7 +1126,12 @@ bool GCS_MAVLINK::should_send_message_in_delay_callback(const ap_message id) con
 
 uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const deferred_message_bucket_t &deferred) const
 {
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+    // stretched if the link can't carry all streams at their requested rates
+    uint32_t interval_ms = MAX(deferred.interval_ms, deferred.scaled_interval_ms);
+#else
     uint32_t interval_ms = deferred.interval_ms;
+#endif
 
     interval_ms += stream_slowdown_ms;
 
@@ -1161,6 +1215,13 @@ ap_message GCS_MAVLINK::next_deferred_bucket_message_to_send(uint16_t now16_ms)
         return no_message_to_send;
     }
 
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+    if (stream_bw.limiting && stream_bw.tokens <= 0) {
+        // streams have used their share of the link for now
+        return no_message_to_send;
+    }
+#endif
+
     const int16_t next = bucket_message_ids_to_send.first_set();
     if (next == -1) {
         // should not happen
@@ -1405,6 +1466,10 @@ void GCS_MAVLINK::update_send()
     // check for any in-progress tasks; check_tasks does its own rate-limiting
     GCS_MAVLINK_InProgress::check_tasks();
 
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+    update_stream_bandwidth();
+#endif
+
     const uint32_t start = AP_HAL::millis();
     const uint16_t start16 = start & 0xFFFF;
     while (AP_HAL::millis() - start < 5) { // spend a max of 5ms sending messages.  This should never trigger - out_of_time() should become true
@@ -1469,11 +1534,25 @@ void GCS_MAVLINK::update_send()
 
         ap_message next = next_deferred_bucket_message_to_send(start16);
         if (next != no_message_to_send) {
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+            const uint32_t tx_bytes_before = stream_bw.tx_bytes;
+#endif
             if (!do_try_send_message(next)) {
                 break;
             }
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+            const uint16_t sent_bytes = stream_bw.tx_bytes - tx_bytes_before;
+            stream_bw.tokens -= sent_bytes;
+            deferred_message_bucket[sending_bucket_id].pass_bytes += sent_bytes;
+#endif
             bucket_message_ids_to_send.clear(next);
             if (bucket_message_ids_to_send.count() == 0) {
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+                deferred_message_bucket_t &bucket = deferred_message_bucket[sending_bucket_id];
+                bucket.bytes_per_pass = bucket.pass_bytes;
+                bucket.pass_bytes = 0;
+                bucket.pass_count++;
+#endif
                 // we sent everything in the bucket.  Reschedule it.
                 // we try to keep output on a regular clock to avoid
                 // user support questions:
@@ -1520,6 +1599,12 @@ void GCS_MAVLINK::remove_message_from_bucket(int8_t bucket, ap_message id)
         // bucket empty.  Free it:
         deferred_message_bucket[bucket].interval_ms = 0;
         deferred_message_bucket[bucket].last_sent_ms = 0;
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+        deferred_message_bucket[bucket].scaled_interval_ms = 0;
+        deferred_message_bucket[bucket].pass_bytes = 0;
+        deferred_message_bucket[bucket].bytes_per_pass = 0;
+        deferred_message_bucket[bucket].pass_count = 0;
+#endif
     }
 
     if (bucket == sending_bucket_id) {
@@ -1541,6 +1626,169 @@ void GCS_MAVLINK::remove_message_from_bucket(int8_t bucket, ap_message id)
     }
 }
 
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+// streamed messages a GCS needs to fly the vehicle get a larger share
+// of the link when there is not enough bandwidth for every stream
+static const ap_message priority_stream_messages[] {
+    MSG_ATTITUDE,
+    MSG_LOCATION,
+    MSG_SYS_STATUS,
+    MSG_GPS_RAW,
+    MSG_VFR_HUD,
+    MSG_EXTENDED_SYS_STATE,
+};
+
+uint8_t GCS_MAVLINK::stream_weight(const deferred_message_bucket_t &bucket) const
+{
+    for (const ap_message id : priority_stream_messages) {
+        if (bucket.ap_message_ids.get(id)) {
+            return 4;
+        }
+    }
+    return 1;
+}
+
+/*
+  measure how fast the link drains and refill the stream token
+  bucket. The drain rate over a window is the number of bytes written
+  less the growth in the port's transmit buffer. That is only the
+  capacity of the link if the buffer backed up during the window, so
+  streams are left alone until that happens. Once limited, each
+  window in which the buffer stays clear raises the estimate by 10%,
+  and streams are released after ten clear windows in a row
+ */
+void GCS_MAVLINK::update_stream_bandwidth()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t now_us = AP_HAL::micros();
+    const uint32_t space = _port->txspace();
+
+    stream_bw.max_txspace = MAX(stream_bw.max_txspace, space);
+    stream_bw.window_min_txspace = MIN(stream_bw.window_min_txspace, space);
+
+    const uint32_t window_ms = now_ms - stream_bw.window_start_ms;
+    if (stream_bw.window_start_ms == 0) {
+        // first call; start measuring
+        stream_bw.window_start_ms = now_ms;
+        stream_bw.window_tx_bytes = stream_bw.tx_bytes;
+        stream_bw.window_txspace = space;
+        stream_bw.window_min_txspace = space;
+    } else if (window_ms >= 1000) {
+        const int32_t drained = int32_t(stream_bw.tx_bytes - stream_bw.window_tx_bytes) +
+                                int32_t(space - stream_bw.window_txspace);
+        const uint32_t measured_bps = uint64_t(MAX(drained, 0)) * 1000U / window_ms;
+        const bool backed_up = stream_bw.window_min_txspace < stream_bw.max_txspace / 2;
+        if (backed_up) {
+            if (!stream_bw.limiting || measured_bps == 0) {
+                stream_bw.drain_bps = MAX(measured_bps, _port->bw_in_bytes_per_second());
+            } else {
+                // smooth over a few windows
+                stream_bw.drain_bps = (stream_bw.drain_bps + measured_bps) / 2;
+            }
+            stream_bw.limiting = true;
+            stream_bw.clear_windows = 0;
+        } else if (stream_bw.limiting) {
+            stream_bw.drain_bps += stream_bw.drain_bps / 10;
+            if (++stream_bw.clear_windows >= 10) {
+                stream_bw.limiting = false;
+                for (auto &bucket : deferred_message_bucket) {
+                    bucket.scaled_interval_ms = bucket.interval_ms;
+                }
+            }
+        }
+        stream_bw.window_start_ms = now_ms;
+        stream_bw.window_tx_bytes = stream_bw.tx_bytes;
+        stream_bw.window_txspace = space;
+        stream_bw.window_min_txspace = space;
+    }
+
+    if (!stream_bw.limiting) {
+        stream_bw.budget_bps = 0;
+        return;
+    }
+
+    // leave some of the link for parameters, missions, ftp and
+    // other messages which are not streamed
+    stream_bw.budget_bps = uint64_t(stream_bw.drain_bps) * 9U / 10U;
+
+    // allow bursts of up to 100ms worth of the budget, but always
+    // enough for a full packet
+    const float max_tokens = MAX(stream_bw.budget_bps * 0.1f, float(packet_overhead() + MAVLINK_MAX_PAYLOAD_LEN));
+    const float dt = (now_us - stream_bw.last_refill_us) * 1.0e-6f;
+    stream_bw.last_refill_us = now_us;
+    stream_bw.tokens = MIN(stream_bw.tokens + stream_bw.budget_bps * dt, max_tokens);
+
+    if (now_ms - stream_bw.last_allocate_ms >= 100) {
+        stream_bw.last_allocate_ms = now_ms;
+        allocate_stream_bandwidth();
+    }
+}
+
+/*
+  share the stream budget between buckets. Each bucket is entitled to
+  a share in proportion to its weight. Buckets needing less than their
+  share are sent at their requested rate and what they leave is shared
+  between the others, whose intervals are stretched to fit
+ */
+void GCS_MAVLINK::allocate_stream_bandwidth()
+{
+    float demand_bps[ARRAY_SIZE(deferred_message_bucket)];
+    uint8_t weight[ARRAY_SIZE(deferred_message_bucket)];
+    uint16_t unallocated = 0;
+    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
+        const deferred_message_bucket_t &bucket = deferred_message_bucket[i];
+        if (bucket.interval_ms == 0) {
+            continue;
+        }
+        uint32_t bytes = bucket.bytes_per_pass;
+        if (bytes == 0) {
+            // not sent yet; assume mid-sized messages
+            bytes = bucket.ap_message_ids.count() * (packet_overhead() + 32U);
+        }
+        demand_bps[i] = bytes * 1000.0f / bucket.interval_ms;
+        weight[i] = stream_weight(bucket);
+        unallocated |= 1U<<i;
+    }
+
+    float remaining_bps = stream_bw.budget_bps;
+    while (unallocated != 0) {
+        uint16_t total_weight = 0;
+        for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
+            if (unallocated & (1U<<i)) {
+                total_weight += weight[i];
+            }
+        }
+        const float bps_per_weight = remaining_bps / total_weight;
+        bool allocated_one = false;
+        for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
+            if ((unallocated & (1U<<i)) && demand_bps[i] <= bps_per_weight * weight[i]) {
+                deferred_message_bucket[i].scaled_interval_ms = deferred_message_bucket[i].interval_ms;
+                remaining_bps -= demand_bps[i];
+                unallocated &= ~(1U<<i);
+                allocated_one = true;
+            }
+        }
+        if (allocated_one) {
+            continue;
+        }
+        // everything left wants more than its share; slow it down
+        for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
+            if (!(unallocated & (1U<<i))) {
+                continue;
+            }
+            deferred_message_bucket_t &bucket = deferred_message_bucket[i];
+            const float share_bps = bps_per_weight * weight[i];
+            float scaled_interval_ms = 60000;
+            if (share_bps > 0) {
+                scaled_interval_ms = MIN(bucket.interval_ms * demand_bps[i] / share_bps, 60000.0f);
+            }
+            bucket.scaled_interval_ms = scaled_interval_ms;
+        }
+        break;
+    }
+}
+#endif  // AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+
 bool GCS_MAVLINK::set_ap_message_interval(enum ap_message id, uint16_t interval_ms)
 {
     if (id == MSG_NEXT_PARAM) {
@@ -1634,6 +1882,9 @@ bool GCS_MAVLINK::set_ap_message_interval(enum ap_message id, uint16_t interval_
         // allocate a bucket for this interval
         deferred_message_bucket[empty_bucket_id].interval_ms = interval_ms;
         deferred_message_bucket[empty_bucket_id].last_sent_ms = AP_HAL::millis16();
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+        deferred_message_bucket[empty_bucket_id].scaled_interval_ms = interval_ms;
+#endif
         closest_bucket = empty_bucket_id;
     }
 
@@ -1896,11 +2147,55 @@ void GCS_MAVLINK::log_mavlink_stats()
     flags                  : flags,
     stream_slowdown_ms     : stream_slowdown_ms,
     times_full             : out_of_space_to_send_count,
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+    drain_bps              : stream_bw.drain_bps,
+    stream_budget_bps      : stream_bw.budget_bps,
+#else
+    drain_bps              : 0,
+    stream_budget_bps      : 0,
+#endif
     };
 
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
+
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+    log_stream_rates();
+#endif
 }
 
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+/*
+  record the requested and achieved rate of each stream bucket
+*/
+void GCS_MAVLINK::log_stream_rates()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = now_ms - stream_bw.stats_start_ms;
+    stream_bw.stats_start_ms = now_ms;
+
+    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
+        deferred_message_bucket_t &bucket = deferred_message_bucket[i];
+        if (bucket.interval_ms == 0) {
+            continue;
+        }
+        const struct log_MAVS pkt{
+            LOG_PACKET_HEADER_INIT(LOG_MAV_STREAM_MSG),
+            time_us            : AP_HAL::micros64(),
+            chan               : (uint8_t)chan,
+            bucket             : i,
+            msg_count          : (uint8_t)bucket.ap_message_ids.count(),
+            interval_ms        : bucket.interval_ms,
+            sent_interval_ms   : get_reschedule_interval_ms(bucket),
+            requested_rate     : 1000.0f / bucket.interval_ms,
+            achieved_rate      : dt_ms > 0 ? bucket.pass_count * 1000.0f / dt_ms : 0,
+            bytes_per_pass     : bucket.bytes_per_pass,
+        };
+        bucket.pass_count = 0;
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+#endif  // AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+
 /*
   send the SYSTEM_TIME message
  */
@@ -2395,6 +2690,15 @@ void GCS::update_send()
 
     service_statustext();
 
+#if HAL_LOGGING_ENABLED
+    // log the routing table and its counters every ten seconds
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_routing_log_ms > 10000) {
+        last_routing_log_ms = now_ms;
+        GCS_MAVLINK::routing.log_routes();
+    }
+#endif
+
     first_backend_to_send++;
     if (first_backend_to_send >= num_gcs()) {
         first_backend_to_send = 0;
@@ -48,6 +48,11 @@ bool GCS_MAVLINK::ftp_init(void) {
         goto failed;
     }
 
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+    // without a read-ahead buffer reads go straight to the filesystem
+    ftp.readahead = new uint8_t[AP_MAVLINK_FTP_READAHEAD_SIZE];
+#endif
+
     if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&GCS_MAVLINK::ftp_worker, void),
                                       "FTP", 2560, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
         goto failed;
@@ -58,6 +63,8 @@ bool GCS_MAVLINK::ftp_init(void) {
 failed:
     delete ftp.requests;
     ftp.requests = nullptr;
+    delete[] ftp.readahead;
+    ftp.readahead = nullptr;
     gcs().send_text(MAV_SEVERITY_WARNING, "failed to initialize MAVFTP");
 
     return false;
@@ -155,6 +162,196 @@ void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
     }
 }
 
+/*
+  read up to len bytes at offset in the open file. If the file can be
+  read ahead then reads come from the read-ahead buffer, which is
+  refilled with a single large read when it doesn't hold the data
+ */
+ssize_t GCS_MAVLINK::ftp_read(uint32_t offset, uint8_t *dest, uint16_t len)
+{
+    if (!ftp.use_readahead) {
+        if (AP::FS().lseek(ftp.fd, offset, SEEK_SET) == -1) {
+            return -1;
+        }
+        return AP::FS().read(ftp.fd, dest, len);
+    }
+
+    if (offset < ftp.readahead_offset ||
+        offset + len > ftp.readahead_offset + ftp.readahead_len) {
+        ftp.readahead_len = 0;
+        if (AP::FS().lseek(ftp.fd, offset, SEEK_SET) == -1) {
+            return -1;
+        }
+        const ssize_t read_bytes = AP::FS().read(ftp.fd, ftp.readahead, AP_MAVLINK_FTP_READAHEAD_SIZE);
+        if (read_bytes == -1) {
+            return -1;
+        }
+        ftp.readahead_offset = offset;
+        ftp.readahead_len = read_bytes;
+    }
+
+    const uint32_t start = offset - ftp.readahead_offset;
+    if (start >= ftp.readahead_len) {
+        return 0;
+    }
+    const uint16_t n = MIN(uint32_t(len), ftp.readahead_len - start);
+    memcpy(dest, &ftp.readahead[start], n);
+    return n;
+}
+
+/*
+  the GCS has asked again for data sent by a burst, so the burst
+  rate is too high for the link
+ */
+void GCS_MAVLINK::ftp_burst_loss(void)
+{
+    ftp.burst_delay_us += ftp.burst_delay_us / 4;
+    ftp.burst_clean_count = 0;
+}
+
+/*
+  answer a re-read of data the GCS missed during a burst without
+  interrupting the burst. The request is turned into its reply in
+  place to save stack in the FTP thread
+ */
+void GCS_MAVLINK::ftp_resend(pending_ftp &msg)
+{
+    const uint8_t size = msg.size;
+
+    msg.req_opcode = msg.opcode;
+    msg.seq_number++;
+    msg.burst_complete = false;
+    memset(msg.data, 0, sizeof(msg.data));
+
+    if (size > sizeof(msg.data)) {
+        ftp_error(msg, FTP_ERROR::InvalidDataSize);
+    } else {
+        const ssize_t read_bytes = ftp_read(msg.offset, msg.data, size);
+        if (read_bytes == -1) {
+            ftp_error(msg, FTP_ERROR::FailErrno);
+        } else if (read_bytes == 0) {
+            ftp_error(msg, FTP_ERROR::EndOfFile);
+        } else {
+            msg.opcode = FTP_OP::Ack;
+            msg.size = (uint8_t)read_bytes;
+        }
+    }
+
+    if (msg.offset < ftp.burst_end_offset) {
+        ftp_burst_loss();
+    }
+
+    ftp_push_replies(msg);
+}
+
+/*
+  send a burst of reads starting at request.offset. Between packets
+  re-reads of data the GCS missed are answered, while any other
+  request from the GCS on this session ends the burst so that the GCS
+  can move the transfer on. Returns true if there is no final reply
+  left to send
+ */
+bool GCS_MAVLINK::ftp_burst_read(const pending_ftp &request, pending_ftp &reply)
+{
+    const uint16_t max_read = (request.size == 0?sizeof(reply.data):request.size);
+
+    if (request.offset < ftp.burst_end_offset) {
+        // the GCS has restarted the burst to fill in data it missed
+        ftp_burst_loss();
+    }
+
+    /*
+      pace the burst on links that don't have flow control. This
+      starts at 1/3 of the available bandwidth, which reduces the
+      chance of lost packets a lot, and then adapts between that and
+      the full bandwidth based on the losses reported by the GCS and
+      whether the UART is keeping up
+     */
+    AP_HAL::UARTDriver *port = valid_channel(request.chan) ? mavlink_comm_port[request.chan] : nullptr;
+    uint32_t min_delay_us = 0;
+    uint16_t pkt_size = 0;
+    if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
+        const uint32_t bw = port->bw_in_bytes_per_second();
+        pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
+        if (bw > 0) {
+            min_delay_us = 1000000U * pkt_size / bw;
+        }
+        if (ftp.burst_delay_us == 0) {
+            ftp.burst_delay_us = 3 * min_delay_us;
+        }
+    }
+
+    // this transfer size is enough for a full parameter file with max parameters
+    const uint32_t transfer_size = 500;
+    for (uint32_t i = 0; (i < transfer_size); i++) {
+        pending_ftp next;
+        while (ftp.requests->peek(&next, 1) == 1 &&
+               next.session == ftp.current_session &&
+               next.sysid == request.sysid && next.compid == request.compid) {
+            if (next.opcode != FTP_OP::ReadFile) {
+                // leave it for the worker
+                return true;
+            }
+            ftp.requests->pop();
+            ftp_resend(next);
+        }
+
+        // fill the buffer
+        reply.offset = request.offset + i * max_read;
+        const ssize_t read_bytes = ftp_read(reply.offset, reply.data, MIN(sizeof(reply.data), max_read));
+        if (read_bytes == -1) {
+            ftp_error(reply, FTP_ERROR::FailErrno);
+            break;
+        }
+
+        if (read_bytes != sizeof(reply.data)) {
+            // don't send any old data
+            memset(reply.data + read_bytes, 0, sizeof(reply.data) - read_bytes);
+        }
+
+        if (read_bytes == 0) {
+            ftp_error(reply, FTP_ERROR::EndOfFile);
+            break;
+        }
+
+        reply.opcode = FTP_OP::Ack;
+        reply.burst_complete = (i == (transfer_size - 1));
+        reply.size = (uint8_t)read_bytes;
+
+        ftp_push_replies(reply);
+
+        ftp.burst_end_offset = MAX(ftp.burst_end_offset, reply.offset + read_bytes);
+
+        if (read_bytes < max_read) {
+            // ensure the NACK which we send next is at the right offset
+            reply.offset += read_bytes;
+        }
+
+        // prep the reply to be used again
+        reply.seq_number++;
+
+        if (min_delay_us == 0) {
+            continue;
+        }
+        if (port->txspace() < 2U * pkt_size) {
+            // the UART isn't keeping up with the burst
+            ftp.burst_delay_us += ftp.burst_delay_us / 4;
+        } else if (++ftp.burst_clean_count >= 32) {
+            ftp.burst_clean_count = 0;
+            ftp.burst_delay_us -= ftp.burst_delay_us / 16;
+        }
+        ftp.burst_delay_us = constrain_uint32(ftp.burst_delay_us, min_delay_us, 3 * min_delay_us);
+        if (ftp.burst_delay_us >= 1000) {
+            hal.scheduler->delay(ftp.burst_delay_us / 1000);
+        } else {
+            hal.scheduler->delay_microseconds(ftp.burst_delay_us);
+        }
+    }
+
+    // prevent a duplicate packet send for normal replies of burst reads
+    return reply.opcode != FTP_OP::Nack;
+}
+
 void GCS_MAVLINK::ftp_worker(void) {
     pending_ftp request;
     pending_ftp reply = {};
@@ -274,6 +471,14 @@ void GCS_MAVLINK::ftp_worker(void) {
                         ftp.mode = FTP_FILE_MODE::Read;
                         ftp.current_session = request.session;
 
+                        // virtual files such as @PARAM/param.pck
+                        // must be read in packet sized blocks
+                        ftp.use_readahead = ftp.readahead != nullptr && request.data[0] != '@';
+                        ftp.readahead_len = 0;
+                        ftp.burst_delay_us = 0;
+                        ftp.burst_end_offset = 0;
+                        ftp.burst_clean_count = 0;
+
                         reply.opcode = FTP_OP::Ack;
                         reply.size = sizeof(uint32_t);
                         put_le32_ptr(reply.data, (uint32_t)file_size);
@@ -298,14 +503,13 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
+                        if (request.offset < ftp.burst_end_offset) {
+                            // filling in data missed during a burst
+                            ftp_burst_loss();
                         }
 
                         // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data),request.size));
+                        const ssize_t read_bytes = ftp_read(request.offset, reply.data, MIN(sizeof(reply.data),request.size));
                         if (read_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -468,7 +672,6 @@ void GCS_MAVLINK::ftp_worker(void) {
                     }
                 case FTP_OP::BurstReadFile:
                     {
-                        const uint16_t max_read = (request.size == 0?sizeof(reply.data):request.size);
                         // must actually be working on a file
                         if (ftp.fd == -1) {
                             ftp_error(reply, FTP_ERROR::FileNotFound);
@@ -481,73 +684,7 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        /*
-                          calculate a burst delay so that FTP burst
-                          transfer doesn't use more than 1/3 of
-                          available bandwidth on links that don't have
-                          flow control. This reduces the chance of
-                          lost packets a lot, which results in overall
-                          faster transfers
-                         */
-                        uint32_t burst_delay_ms = 0;
-                        if (valid_channel(request.chan)) {
-                            auto *port = mavlink_comm_port[request.chan];
-                            if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
-                                const uint32_t bw = port->bw_in_bytes_per_second();
-                                const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
-                                burst_delay_ms = 3000 * pkt_size / bw;
-                            }
-                        }
-
-                        // this transfer size is enough for a full parameter file with max parameters
-                        const uint32_t transfer_size = 500;
-                        for (uint32_t i = 0; (i < transfer_size); i++) {
-                            // fill the buffer
-                            const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data), max_read));
-                            if (read_bytes == -1) {
-                                ftp_error(reply, FTP_ERROR::FailErrno);
-                                break;
-                            }
-
-                            if (read_bytes != sizeof(reply.data)) {
-                                // don't send any old data
-                                memset(reply.data + read_bytes, 0, sizeof(reply.data) - read_bytes);
-                            }
-
-                            if (read_bytes == 0) {
-                                ftp_error(reply, FTP_ERROR::EndOfFile);
-                                break;
-                            }
-
-                            reply.opcode = FTP_OP::Ack;
-                            reply.offset = request.offset + i * max_read;
-                            reply.burst_complete = (i == (transfer_size - 1));
-                            reply.size = (uint8_t)read_bytes;
-
-                            ftp_push_replies(reply);
-
-                            if (read_bytes < max_read) {
-                                // ensure the NACK which we send next is at the right offset
-                                reply.offset += read_bytes;
-                            }
-
-                            // prep the reply to be used again
-                            reply.seq_number++;
-
-                            hal.scheduler->delay(burst_delay_ms);
-                        }
-
-                        if (reply.opcode != FTP_OP::Nack) {
-                            // prevent a duplicate packet send for
-                            // normal replies of burst reads
-                            skip_push_reply = true;
-                        }
+                        skip_push_reply = ftp_burst_read(request, reply);
                         break;
                     }
 
@@ -43,6 +43,14 @@ bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
 static HAL_Semaphore chan_locks[MAVLINK_COMM_NUM_BUFFERS];
 static bool chan_discard[MAVLINK_COMM_NUM_BUFFERS];
 
+// UART transmit buffer space reserved by comm_send_lock() for the
+// packet being sent, which comm_send_buffer() copies straight into
+static struct {
+    ByteBuffer::IoVec vec[2];
+    uint8_t num_vec;
+    uint16_t written;
+} chan_reserved[MAVLINK_COMM_NUM_BUFFERS];
+
 mavlink_system_t mavlink_system = {7,1};
 
 // routing table
@@ -110,6 +118,29 @@ uint16_t comm_get_txspace(mavlink_channel_t chan)
     return link->txspace();
 }
 
+/*
+  copy part of a packet into the space reserved for it in the UART
+  transmit buffer, returning the number of bytes copied
+ */
+static uint16_t comm_copy_to_reserved(uint8_t chan, const uint8_t *buf, uint8_t len)
+{
+    auto &r = chan_reserved[chan];
+    uint16_t ofs = r.written;
+    uint16_t copied = 0;
+    for (uint8_t i=0; i<r.num_vec && copied < len; i++) {
+        if (ofs >= r.vec[i].len) {
+            ofs -= r.vec[i].len;
+            continue;
+        }
+        const uint16_t n = MIN(uint32_t(len - copied), r.vec[i].len - ofs);
+        memcpy(&r.vec[i].data[ofs], &buf[copied], n);
+        copied += n;
+        ofs = 0;
+    }
+    r.written += copied;
+    return copied;
+}
+
 /*
   send a buffer out a MAVLink channel
  */
@@ -129,7 +160,18 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
         // an alternative protocol is active
         return;
     }
-    const size_t written = mavlink_comm_port[chan]->write(buf, len);
+    size_t written;
+    if (chan_reserved[chan].num_vec != 0) {
+        written = comm_copy_to_reserved(chan, buf, len);
+    } else {
+        written = mavlink_comm_port[chan]->write(buf, len);
+    }
+#if AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+    GCS_MAVLINK *c = gcs().chan(chan);
+    if (c != nullptr) {
+        c->count_tx_bytes(written);
+    }
+#endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     if (written < len) {
         AP_HAL::panic("Short write on UART: %lu < %u", (unsigned long)written, len);
@@ -143,7 +185,9 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
   lock a channel for send
   if there is insufficient space to send size bytes then all bytes
   written to the channel by the mavlink library will be discarded
-  while the lock is held.
+  while the lock is held. Otherwise, if the UART supports it, size
+  bytes of its transmit buffer are reserved so the packet can be
+  written into it without a write() call per part of the packet
  */
 void comm_send_lock(mavlink_channel_t chan_m, uint16_t size)
 {
@@ -152,6 +196,12 @@ void comm_send_lock(mavlink_channel_t chan_m, uint16_t size)
     if (mavlink_comm_port[chan]->txspace() < size) {
         chan_discard[chan] = true;
         gcs_out_of_space_to_send(chan_m);
+        return;
+    }
+    auto &r = chan_reserved[chan];
+    if (r.num_vec == 0 && !gcs_alternative_active[chan]) {
+        r.num_vec = mavlink_comm_port[chan]->write_reserve(r.vec, size);
+        r.written = 0;
     }
 }
 
@@ -161,6 +211,11 @@ void comm_send_lock(mavlink_channel_t chan_m, uint16_t size)
 void comm_send_unlock(mavlink_channel_t chan_m)
 {
     const uint8_t chan = uint8_t(chan_m);
+    auto &r = chan_reserved[chan];
+    if (r.num_vec != 0) {
+        mavlink_comm_port[chan]->write_commit(r.written);
+        r.num_vec = 0;
+    }
     chan_discard[chan] = false;
     chan_locks[chan].give();
 }
@@ -36,3 +36,19 @@
 #define HAL_MAVLINK_INTERVALS_FROM_FILES_ENABLED ((AP_FILESYSTEM_FATFS_ENABLED || AP_FILESYSTEM_POSIX_ENABLED) && BOARD_FLASH_SIZE > 1024)
 #endif
 
+// fit streamed messages into the measured bandwidth of each link
+// using a per-link token bucket, sharing it between streams by weight
+#ifndef AP_MAVLINK_STREAM_BANDWIDTH_ENABLED
+#define AP_MAVLINK_STREAM_BANDWIDTH_ENABLED (BOARD_FLASH_SIZE > 1024)
+#endif
+
+// size of the read-ahead buffer for MAVLink FTP reads. Large
+// filesystem reads are much cheaper per byte than one per packet, and
+// recently sent data can be re-sent to the GCS without a seek
+#ifndef AP_MAVLINK_FTP_READAHEAD_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 4096
+#else
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 0
+#endif
+#endif
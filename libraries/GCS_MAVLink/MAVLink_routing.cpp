@@ -21,13 +21,28 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS.h"
 #include "MAVLink_routing.h"
+#include <AP_Logger/AP_Logger.h>
 
 extern const AP_HAL::HAL& hal;
 
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) : num_routes(0)
+{
+    memset(route_hash, no_route, sizeof(route_hash));
+    memset(chan_first_route, no_route, sizeof(chan_first_route));
+}
+
+// length of a packet on the wire
+static uint16_t packet_length(const mavlink_message_t &msg)
+{
+    uint16_t len = msg.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    if (msg.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        len += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    return len;
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -99,7 +114,18 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
 
     // learn new routes including private channels
     // so that find_mav_type works for all channels
-    learn_route(in_link, msg);
+    struct route *in_route = learn_route(in_link, msg);
+    if (in_route != nullptr) {
+        in_route->rx_packets++;
+        in_route->rx_bytes += packet_length(msg);
+        // a packet which has come round a loop says nothing about
+        // the rate of the sender
+        const uint16_t now_ms = AP_HAL::millis16();
+        if (!loop_cache.seen_recently(in_link.get_chan() - MAVLINK_COMM_0, msg.sysid, msg.compid, msg.seq, msg.msgid,
+                                      now_ms, in_route->seq_wrap.loop_window_ms())) {
+            in_route->seq_wrap.update(msg.seq, now_ms);
+        }
+    }
 
     if (msg.msgid == MAVLINK_MSG_ID_RADIO ||
         msg.msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
@@ -144,44 +170,85 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
         return true;
     }
 
-    // forward on any channels matching the targets
-    bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
+    // find the channels matching the targets
+    const mavlink_channel_t in_channel = in_link.get_chan();
+    uint16_t chan_mask = 0;
+    struct route *fwd_route[MAVLINK_COMM_NUM_BUFFERS] {};
+    if (broadcast_system) {
+        // broadcasts go to every channel we have learned a route on,
+        // apart from private channels, which only get packets
+        // targeted at a route on them
+        for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+            if (chan_first_route[i] != no_route) {
+                fwd_route[i] = &routes[chan_first_route[i]];
+                chan_mask |= 1U<<i;
+            }
+        }
+        chan_mask &= ~GCS_MAVLINK::private_channel_mask();
+    } else {
+        // only the routes for the target system need to be looked at
+        for (uint8_t i=route_hash[route_hash_index(target_system)]; i<num_routes; i=routes[i].next) {
+            struct route &r = routes[i];
+            if (target_system != r.sysid) {
+                // another system on the same hash chain
+                continue;
+            }
 
-        // Skip if channel is private and the target system or component IDs do not match
-        GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
-        if (out_link == nullptr) {
-            // this is bad
+            // Skip if channel is private and the target component ID does not match
+            const uint8_t chan_ofs = r.channel - MAVLINK_COMM_0;
+            if ((GCS_MAVLINK::private_channel_mask() & (1U<<chan_ofs)) &&
+                target_component != r.compid) {
+                continue;
+            }
+
+            if (broadcast_component ||
+                target_component == r.compid ||
+                !match_system) {
+                if (fwd_route[chan_ofs] == nullptr) {
+                    fwd_route[chan_ofs] = &r;
+                }
+                chan_mask |= 1U<<chan_ofs;
+            }
+        }
+    }
+    chan_mask &= ~(1U<<(in_channel-MAVLINK_COMM_0));
+
+    bool forwarded = chan_mask != 0;
+    if (forwarded) {
+        // keep the loop window well inside the time it takes the
+        // sender's sequence number to wrap, so that a new packet
+        // with a reused seq isn't mistaken for a looped one
+        const uint16_t window_ms = in_route != nullptr ? in_route->seq_wrap.loop_window_ms() : MAVLink_routing_seq_wrap::unknown_rate_window_ms;
+        if (loop_cache.forwarded_recently(in_channel - MAVLINK_COMM_0, msg.sysid, msg.compid, msg.seq, msg.msgid,
+                                          AP_HAL::millis16(), window_ms)) {
+            // we have already forwarded this packet from this
+            // channel, it has come back to us around a loop
+            chan_mask = 0;
+        }
+    }
+
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(chan_mask & (1U<<i))) {
             continue;
         }
-        if (out_link->is_private() &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
+        struct route &r = *fwd_route[i];
+        GCS_MAVLINK *out_link = gcs().chan(r.channel);
+        if (out_link == nullptr) {
+            // this is bad
             continue;
         }
-
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
-
-            if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
-                if (out_link->check_payload_size(msg.len)) {
+        if (out_link->check_payload_size(msg.len)) {
 #if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_link->get_chan(),
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
+            ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                     msg.msgid,
+                     (unsigned)in_channel,
+                     (unsigned)r.channel,
+                     (int)target_system,
+                     (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
-            }
+            _mavlink_resend_uart(r.channel, &msg);
+            r.fwd_packets++;
+            r.fwd_bytes += packet_length(msg);
         }
     }
 
@@ -212,7 +279,7 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
 
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=route_hash[route_hash_index(mavlink_system.sysid)]; i<num_routes; i=routes[i].next) {
         if (routes[i].sysid != mavlink_system.sysid) {
             // our system ID hasn't been seen on this link
             continue;
@@ -286,56 +353,66 @@ bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid
 }
 
 /*
-  see if the message is for a new route and learn it
+  see if the message is for a new route and learn it. Returns the
+  route the message came from, or nullptr if there isn't one
 */
-void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg)
+MAVLink_routing::route *MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0) {
         // don't learn routes to the broadcast system
-        return;
+        return nullptr;
     }
     if (msg.sysid == mavlink_system.sysid &&
         msg.compid == mavlink_system.compid) {
         // don't learn routes to ourself.  We know where we are.
-        return;
+        return nullptr;
     }
     if (msg.sysid == mavlink_system.sysid &&
         msg.compid == MAV_COMP_ID_ALL) {
         // don't learn routes to the broadcast component ID for our
         // own system id.  We should still broadcast these, but we
         // should also process them locally.
-        return;
+        return nullptr;
     }
     const mavlink_channel_t in_channel = in_link.get_chan();
-    for (i=0; i<num_routes; i++) {
+    const uint8_t h = route_hash_index(msg.sysid);
+    for (uint8_t i=route_hash[h]; i<num_routes; i=routes[i].next) {
         if (routes[i].sysid == msg.sysid &&
             routes[i].compid == msg.compid &&
             routes[i].channel == in_channel) {
             if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
                 routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
             }
-            break;
+            return &routes[i];
         }
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-        }
-        num_routes++;
+    if (num_routes >= MAVLINK_MAX_ROUTES) {
+        routes_dropped++;
+        return nullptr;
+    }
+    struct route &r = routes[num_routes];
+    r.sysid = msg.sysid;
+    r.compid = msg.compid;
+    r.channel = in_channel;
+    if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        r.mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+    r.next = route_hash[h];
+    route_hash[h] = num_routes;
+    const uint8_t chan_ofs = in_channel - MAVLINK_COMM_0;
+    if (chan_first_route[chan_ofs] == no_route) {
+        chan_first_route[chan_ofs] = num_routes;
+    }
+    num_routes++;
 #if ROUTING_DEBUG
-        ::printf("learned route %u %u via %u\n",
-                 (unsigned)msg.sysid,
-                 (unsigned)msg.compid,
-                 (unsigned)in_channel);
+    ::printf("learned route %u %u via %u\n",
+             (unsigned)msg.sysid,
+             (unsigned)msg.compid,
+             (unsigned)in_channel);
 #endif
-    }
+    return &r;
 }
 
-
 /*
   special handling for heartbeat messages. To ensure routing
   propagation heartbeat messages need to be forwarded on all channels
@@ -355,7 +432,7 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=route_hash[route_hash_index(msg.sysid)]; i<num_routes; i=routes[i].next) {
         if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
             mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
         }
@@ -405,3 +482,35 @@ void MAVLink_routing::get_targets(const mavlink_message_t &msg, int16_t &sysid,
     }
 }
 
+/*
+  log the routing table and per-route counters
+*/
+void MAVLink_routing::log_routes()
+{
+#if HAL_LOGGING_ENABLED
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr) {
+        return;
+    }
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i=0; i<num_routes; i++) {
+        const struct route &r = routes[i];
+        const struct log_MAVR pkt{
+            LOG_PACKET_HEADER_INIT(LOG_MAV_ROUTE_MSG),
+            time_us        : now_us,
+            instance       : i,
+            sysid          : r.sysid,
+            compid         : r.compid,
+            chan           : (uint8_t)r.channel,
+            mavtype        : r.mavtype,
+            rx_packets     : r.rx_packets,
+            rx_bytes       : r.rx_bytes,
+            fwd_packets    : r.fwd_packets,
+            fwd_bytes      : r.fwd_bytes,
+            routes_dropped : routes_dropped,
+            loop_drops     : loop_cache.drops(),
+        };
+        logger->WriteBlock(&pkt, sizeof(pkt));
+    }
+#endif
+}
@@ -4,10 +4,26 @@
 
 #include <AP_Common/AP_Common.h>
 #include "GCS_MAVLink.h"
+#include "MAVLink_routing_loop.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+// maximum number of sysid/compid/channel routes we learn. Swarms and
+// companion computers can put many components behind one autopilot,
+// so boards with the memory for it get a larger table
+#ifndef MAVLINK_MAX_ROUTES
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define MAVLINK_MAX_ROUTES 64
+#else
 #define MAVLINK_MAX_ROUTES 20
+#endif
+#endif
+
+// number of hash chains routes are spread over, must be a power of 2
+#ifndef MAVLINK_ROUTE_HASH_SIZE
+#define MAVLINK_ROUTE_HASH_SIZE 32
+#endif
+
+static_assert(MAVLINK_MAX_ROUTES < UINT8_MAX, "route indexes must fit in a uint8_t");
+static_assert((MAVLINK_ROUTE_HASH_SIZE & (MAVLINK_ROUTE_HASH_SIZE-1)) == 0, "MAVLINK_ROUTE_HASH_SIZE must be a power of 2");
 
 /*
   object to handle MAVLink packet routing
@@ -49,22 +65,50 @@ public:
      */
     bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const;
 
+    /*
+      log the routing table and per-route counters
+     */
+    void log_routes();
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    // routes are kept in the order they were learned, so searches by
+    // mavtype find the oldest route first. Each route is also on a
+    // hash chain for its sysid, so finding the routes for a packet
+    // doesn't depend on the size of the table
+    static const uint8_t no_route = UINT8_MAX;
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
         mavlink_channel_t channel;
         uint8_t mavtype;
+        uint8_t next; // next route on the same hash chain
+        uint32_t rx_packets; // packets received from this route
+        uint32_t rx_bytes;
+        uint32_t fwd_packets; // packets forwarded because of this route
+        uint32_t fwd_bytes;
+        MAVLink_routing_seq_wrap seq_wrap; // how often the sender's seq wraps on this channel
     } routes[MAVLINK_MAX_ROUTES];
-    
+    uint8_t route_hash[MAVLINK_ROUTE_HASH_SIZE];
+    // first route learned on each channel
+    uint8_t chan_first_route[MAVLINK_COMM_NUM_BUFFERS];
+
+    // number of routes not learned because the table was full
+    uint32_t routes_dropped;
+
+    static uint8_t route_hash_index(uint8_t sysid) {
+        return sysid & (MAVLINK_ROUTE_HASH_SIZE-1);
+    }
+
+    // packets recently forwarded, so a packet which comes back to us
+    // over a loop in the network is not forwarded again
+    MAVLink_routing_loop_cache loop_cache;
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
     
-    // learn new routes
-    void learn_route(GCS_MAVLINK &link, const mavlink_message_t &msg);
+    // learn new routes, returning the route for the message or nullptr
+    struct route *learn_route(GCS_MAVLINK &link, const mavlink_message_t &msg);
 
     // extract target sysid and compid from a message
     void get_targets(const mavlink_message_t &msg, int16_t &sysid, int16_t &compid);
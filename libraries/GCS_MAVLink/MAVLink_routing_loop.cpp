@@ -0,0 +1,102 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file	MAVLink_routing_loop.cpp
+/// @brief	detection of MAVLink packets forwarded around a loop
+
+#include "MAVLink_routing_loop.h"
+
+#include <AP_Math/AP_Math.h>
+
+// forwarded packets seen again within this time are assumed to have
+// come round a loop
+#define ROUTING_LOOP_TIMEOUT_MS MAVLink_routing_seq_wrap::unknown_rate_window_ms
+
+// the window is at most this fraction of the sender's sequence wrap period
+#define ROUTING_LOOP_WRAP_FRACTION 8
+
+// the wrap period is re-measured each time the sequence number has
+// advanced this far, half a wrap so it is known before the first reuse
+#define ROUTING_LOOP_SEQ_MEASURE 128U
+
+void MAVLink_routing_seq_wrap::update(uint8_t seq, uint16_t now_ms)
+{
+    if (!seen_packet) {
+        last_seq = seq;
+        last_ms = now_ms;
+        seen_packet = true;
+        return;
+    }
+    // only a step of less than half the sequence space is forward
+    // progress; anything else is a repeated or reordered packet, and
+    // a wrap is a large backwards jump in the raw value
+    const uint8_t advance = seq - last_seq;
+    if (advance == 0 || advance >= 128) {
+        return;
+    }
+    cycle_ms += uint16_t(now_ms - last_ms);
+    cycle_advance += advance;
+    last_seq = seq;
+    last_ms = now_ms;
+    if (cycle_advance >= ROUTING_LOOP_SEQ_MEASURE) {
+        wrap_period_ms = MIN(uint32_t(UINT16_MAX), cycle_ms * 256U / cycle_advance);
+        cycle_ms = 0;
+        cycle_advance = 0;
+    }
+}
+
+uint16_t MAVLink_routing_seq_wrap::loop_window_ms() const
+{
+    if (wrap_period_ms == 0) {
+        return unknown_rate_window_ms;
+    }
+    return MIN(ROUTING_LOOP_TIMEOUT_MS, wrap_period_ms / ROUTING_LOOP_WRAP_FRACTION);
+}
+
+uint8_t MAVLink_routing_loop_cache::index(uint8_t chan, uint8_t sysid, uint8_t compid, uint8_t seq, uint32_t msgid)
+{
+    return (seq ^ (sysid * 7U) ^ (compid * 13U) ^ (msgid * 31U) ^ (chan * 17U)) & (MAVLINK_ROUTE_LOOP_CACHE_SIZE-1);
+}
+
+bool MAVLink_routing_loop_cache::seen_recently(uint8_t chan, uint8_t sysid, uint8_t compid, uint8_t seq, uint32_t msgid,
+                                               uint16_t now_ms, uint16_t window_ms) const
+{
+    const struct entry &e = _entries[index(chan, sysid, compid, seq, msgid)];
+    return e.valid &&
+        e.chan == chan &&
+        e.sysid == sysid &&
+        e.compid == compid &&
+        e.seq == seq &&
+        e.msgid == msgid &&
+        uint16_t(now_ms - e.time_ms) < window_ms;
+}
+
+bool MAVLink_routing_loop_cache::forwarded_recently(uint8_t chan, uint8_t sysid, uint8_t compid, uint8_t seq, uint32_t msgid,
+                                                    uint16_t now_ms, uint16_t window_ms)
+{
+    if (seen_recently(chan, sysid, compid, seq, msgid, now_ms, window_ms)) {
+        _drops++;
+        return true;
+    }
+    struct entry &e = _entries[index(chan, sysid, compid, seq, msgid)];
+    e.valid = true;
+    e.chan = chan;
+    e.sysid = sysid;
+    e.compid = compid;
+    e.seq = seq;
+    e.msgid = msgid;
+    e.time_ms = now_ms;
+    return false;
+}
@@ -0,0 +1,83 @@
+/// @file	MAVLink_routing_loop.h
+/// @brief	detection of MAVLink packets forwarded around a loop
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <stdint.h>
+
+// number of recently forwarded packets remembered to stop forwarding
+// loops, must be a power of 2
+#ifndef MAVLINK_ROUTE_LOOP_CACHE_SIZE
+#define MAVLINK_ROUTE_LOOP_CACHE_SIZE 32
+#endif
+
+static_assert((MAVLINK_ROUTE_LOOP_CACHE_SIZE & (MAVLINK_ROUTE_LOOP_CACHE_SIZE-1)) == 0, "MAVLINK_ROUTE_LOOP_CACHE_SIZE must be a power of 2");
+
+/*
+  tracks how often the sequence number of a sender on one channel
+  wraps, so that a repeated sequence number is only taken to be a
+  loop well within one wrap. The period is measured from the forward
+  progress of the sequence number, so repeated or reordered packets
+  are not mistaken for wraps
+ */
+class MAVLink_routing_seq_wrap
+{
+public:
+    // note a packet from the sender. Packets dropped as looped must
+    // not be passed in
+    void update(uint8_t seq, uint16_t now_ms);
+
+    // time within which a repeated packet from the sender is taken to
+    // have come round a loop
+    uint16_t loop_window_ms() const;
+
+    // window used until the sender's wrap period is known. A sender
+    // can't reuse a sequence number before then, so this only has to
+    // cover the slowest loop, e.g. through a pair of radios
+    static constexpr uint16_t unknown_rate_window_ms = 200;
+
+private:
+    uint32_t cycle_ms;          // time taken by cycle_advance
+    uint16_t cycle_advance;     // sequence numbers advanced in this measurement
+    uint16_t last_ms;
+    uint16_t wrap_period_ms;    // zero until measured
+    uint8_t last_seq;
+    bool seen_packet;
+};
+
+/*
+  cache of recently forwarded packets, so a packet which comes back to
+  us over a loop in the network is not forwarded again. Packets are
+  keyed on the channel they arrived on as well as the sender, sequence
+  number and message id, so the same packet arriving over redundant
+  links is forwarded from each of them
+ */
+class MAVLink_routing_loop_cache
+{
+public:
+    // returns true if this packet was forwarded within window_ms
+    bool seen_recently(uint8_t chan, uint8_t sysid, uint8_t compid, uint8_t seq, uint32_t msgid,
+                       uint16_t now_ms, uint16_t window_ms) const;
+
+    // returns true if this packet was forwarded within window_ms,
+    // otherwise remembers it
+    bool forwarded_recently(uint8_t chan, uint8_t sysid, uint8_t compid, uint8_t seq, uint32_t msgid,
+                            uint16_t now_ms, uint16_t window_ms);
+
+    // number of packets not forwarded because they came round a loop
+    uint32_t drops() const { return _drops; }
+
+private:
+    static uint8_t index(uint8_t chan, uint8_t sysid, uint8_t compid, uint8_t seq, uint32_t msgid);
+
+    struct entry {
+        uint32_t msgid;
+        uint16_t time_ms;
+        uint8_t chan;
+        uint8_t sysid;
+        uint8_t compid;
+        uint8_t seq;
+        bool valid;
+    } _entries[MAVLINK_ROUTE_LOOP_CACHE_SIZE];
+    uint32_t _drops;
+};
@@ -11,6 +11,8 @@ void MissionItemProtocol::init_send_requests(GCS_MAVLINK &_link,
     timelast_receive_ms = AP_HAL::millis();    // set time we last received commands to now
     receiving = true;              // record that we expect to receive commands
     request_i = _request_first;                 // reset the next expected command number to zero
+    request_next = _request_first;
+    received_mask = 0;
     request_last = _request_last;         // record how many commands we expect to receive
 
     dest_sysid = msg.sysid;       // record system id of GCS who wants to upload the mission
@@ -238,11 +240,21 @@ void MissionItemProtocol::handle_mission_item(const mavlink_message_t &msg, cons
         return;
     }
 
-    // check if this is the requested waypoint
-    if (cmd.seq != request_i) {
+    // check if this is one of the requested waypoints
+    const uint8_t window = request_window();
+    if (cmd.seq < request_i || cmd.seq > request_last || cmd.seq - request_i >= window) {
+        if (window > 1 && cmd.seq < request_i) {
+            // a repeat of an item we already have, sent in answer to
+            // a repeated request
+            return;
+        }
         send_mission_ack(msg, MAV_MISSION_INVALID_SEQUENCE);
         return;
     }
+    const uint32_t received_bit = 1U << (cmd.seq - request_i);
+    if (received_mask & received_bit) {
+        return;
+    }
     // make sure the item is coming from the system that initiated the upload
     if (msg.sysid != dest_sysid) {
         send_mission_ack(msg, MAV_MISSION_DENIED);
@@ -274,9 +286,14 @@ void MissionItemProtocol::handle_mission_item(const mavlink_message_t &msg, cons
         return;
     }
 
-    // update waypoint receiving state machine
+    // update waypoint receiving state machine, moving the window
+    // past all the items received
     timelast_receive_ms = AP_HAL::millis();
-    request_i++;
+    received_mask |= received_bit;
+    while (received_mask & 1U) {
+        received_mask >>= 1;
+        request_i++;
+    }
 
     if (request_i > request_last) {
         transfer_is_complete(*link, msg);
@@ -321,29 +338,37 @@ void MissionItemProtocol::send_mission_ack(const GCS_MAVLINK &_link,
 }
 
 /**
- * @brief Send the next pending waypoint, called from deferred message
- * handling code
+ * @brief Send requests for the items in the window not yet requested,
+ * called from deferred message handling code
  */
 void MissionItemProtocol::queued_request_send()
 {
     if (!receiving) {
         return;
     }
-    if (request_i > request_last) {
-        return;
-    }
     if (link == nullptr) {
         INTERNAL_ERROR(AP_InternalError::error_t::gcs_bad_missionprotocol_link);
         return;
     }
-    CHECK_PAYLOAD_SIZE2_VOID(link->get_chan(), MISSION_REQUEST);
-    mavlink_msg_mission_request_send(
-        link->get_chan(),
-        dest_sysid,
-        dest_compid,
-        request_i,
-        mission_type());
-    timelast_request_ms = AP_HAL::millis();
+    const uint32_t window_last = MIN(uint32_t(request_last), uint32_t(request_i) + request_window() - 1);
+    if (request_next < request_i) {
+        request_next = request_i;
+    }
+    while (request_next <= window_last) {
+        if (received_mask & (1U << (request_next - request_i))) {
+            request_next++;
+            continue;
+        }
+        CHECK_PAYLOAD_SIZE2_VOID(link->get_chan(), MISSION_REQUEST);
+        mavlink_msg_mission_request_send(
+            link->get_chan(),
+            dest_sysid,
+            dest_compid,
+            request_next,
+            mission_type());
+        timelast_request_ms = AP_HAL::millis();
+        request_next++;
+    }
 }
 
 void MissionItemProtocol::update()
@@ -377,6 +402,8 @@ void MissionItemProtocol::update()
     const uint32_t wp_recv_timeout_ms = 1000U + link->get_stream_slowdown_ms();
     if (tnow - timelast_request_ms > wp_recv_timeout_ms) {
         timelast_request_ms = tnow;
+        // request all the items in the window we don't have again
+        request_next = request_i;
         link->send_message(next_item_ap_message_id());
     }
 }
@@ -21,6 +21,9 @@
 // Starting of uploads (for the same protocol) is also blocked -
 // essentially the GCS uploading a set of items (e.g. a mission) has a
 // mutex over the mission.
+//
+// Backends which can accept items out of order may allow several
+// items to be requested at once; see request_window().
 class MissionItemProtocol
 {
 public:
@@ -75,6 +78,10 @@ protected:
 
     virtual bool clear_all_items() = 0;
 
+    // return the number of items which may be requested from the GCS
+    // at once. Items within the window may arrive in any order
+    virtual uint8_t request_window() const { return 1; }
+
     uint16_t        request_last; // last request index
 
 private:
@@ -82,6 +89,8 @@ private:
     virtual void truncate(const mavlink_mission_count_t &packet) = 0;
 
     uint16_t        request_i; // request index
+    uint16_t        request_next; // next index in the window to send a request for
+    uint32_t        received_mask; // items in the window received, bit 0 is request_i
 
     // waypoints
     uint8_t         dest_sysid;  // where to send requests
@@ -50,8 +50,40 @@ bool MissionItemProtocol_Waypoints::clear_all_items()
     return mission.clear();
 }
 
+MAV_MISSION_RESULT MissionItemProtocol_Waypoints::allocate_receive_resources(const uint16_t count)
+{
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    // without the memory to stage the mission it is written to
+    // storage item by item as it arrives instead
+    (void)mission.staging_begin(count);
+#endif
+    return MAV_MISSION_ACCEPTED;
+}
+
+void MissionItemProtocol_Waypoints::free_upload_resources()
+{
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    mission.staging_abort();
+#endif
+}
+
+uint8_t MissionItemProtocol_Waypoints::request_window() const
+{
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    if (mission.staging_active()) {
+        return staged_request_window;
+    }
+#endif
+    return 1;
+}
+
 MAV_MISSION_RESULT MissionItemProtocol_Waypoints::complete(const GCS_MAVLINK &_link)
 {
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    if (mission.staging_active() && !mission.staging_commit()) {
+        return MAV_MISSION_ERROR;
+    }
+#endif
     _link.send_text(MAV_SEVERITY_INFO, "Flight plan received");
     AP::logger().Write_EntireMission();
     return MAV_MISSION_ACCEPTED;
@@ -101,6 +133,12 @@ MAV_MISSION_RESULT MissionItemProtocol_Waypoints::get_item(const GCS_MAVLINK &_l
 }
 
 uint16_t MissionItemProtocol_Waypoints::item_count() const {
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    if (mission.staging_active()) {
+        // every item of the staged mission is replaced as it arrives
+        return mission.staging_count();
+    }
+#endif
     return mission.num_commands();
 }
 
@@ -123,6 +161,11 @@ MAV_MISSION_RESULT MissionItemProtocol_Waypoints::replace_item(const mavlink_mis
             return MAV_MISSION_ERROR;
         }
     }
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    if (mission.staging_active()) {
+        return mission.staging_set_cmd(cmd.index, cmd) ? MAV_MISSION_ACCEPTED : MAV_MISSION_ERROR;
+    }
+#endif
     if (!mission.replace_cmd(cmd.index, cmd)) {
         return MAV_MISSION_ERROR;
     }
@@ -136,6 +179,12 @@ void MissionItemProtocol_Waypoints::timeout()
 
 void MissionItemProtocol_Waypoints::truncate(const mavlink_mission_count_t &packet)
 {
+#if AP_MISSION_STAGED_UPLOAD_ENABLED
+    if (mission.staging_active()) {
+        // the whole mission is replaced when the upload completes
+        return;
+    }
+#endif
     // new mission arriving, truncate mission to be the same length
     mission.truncate(packet.count);
 }
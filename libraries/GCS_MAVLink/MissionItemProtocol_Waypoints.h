@@ -38,9 +38,23 @@ protected:
         return MSG_NEXT_MISSION_REQUEST_WAYPOINTS;
     }
 
+    // request_window() returns the number of items requested from the
+    // GCS at once; more than one when the mission is being staged
+    uint8_t request_window() const override;
+
 private:
     AP_Mission &mission;
 
+    // number of items requested at once when staging a mission
+    static const uint8_t staged_request_window = 8;
+
+    // allocate_receive_resources() starts staging the new mission in
+    // RAM if there is space for it, otherwise items are written
+    // straight to storage as they arrive
+    MAV_MISSION_RESULT allocate_receive_resources(const uint16_t count) override WARN_IF_UNUSED;
+    // free_upload_resources() discards any staged mission
+    void free_upload_resources() override;
+
     // append_item() is called by the base class to add the supplied
     // item to the end of the list of stored items.
     MAV_MISSION_RESULT append_item(const mavlink_mission_item_int_t &) override WARN_IF_UNUSED;
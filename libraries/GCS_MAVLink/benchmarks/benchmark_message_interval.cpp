@@ -0,0 +1,70 @@
+#include <AP_gbenchmark.h>
+
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <AP_Scheduler/AP_Scheduler.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+static AP_Scheduler scheduler;
+static GCS_Dummy _gcs;
+static GCS_MAVLINK_Parameters link_params;
+static GCS_MAVLINK_Dummy link{link_params, *hal.serial(0)};
+
+// messages a companion computer typically asks for, in the order it
+// asks for them
+static const uint32_t mavlink_ids[] {
+    MAVLINK_MSG_ID_ATTITUDE,
+    MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
+    MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+    MAVLINK_MSG_ID_LOCAL_POSITION_NED,
+    MAVLINK_MSG_ID_SYS_STATUS,
+    MAVLINK_MSG_ID_GPS_RAW_INT,
+    MAVLINK_MSG_ID_VFR_HUD,
+    MAVLINK_MSG_ID_RC_CHANNELS,
+    MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,
+    MAVLINK_MSG_ID_BATTERY_STATUS,
+    MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
+    MAVLINK_MSG_ID_HOME_POSITION,
+    MAVLINK_MSG_ID_VIBRATION,
+    MAVLINK_MSG_ID_EKF_STATUS_REPORT,
+    MAVLINK_MSG_ID_WINCH_STATUS,
+    MAVLINK_MSG_ID_AUTOPILOT_VERSION,
+};
+
+// re-requesting the interval each message is already sent at, as a
+// companion computer does every second
+static void BM_SetMessageIntervalUnchanged(benchmark::State& state)
+{
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        MAV_RESULT ret = link.set_message_interval(mavlink_ids[i], 100000);
+        gbenchmark_escape(&ret);
+        i = (i + 1) % ARRAY_SIZE(mavlink_ids);
+    }
+}
+
+// moving messages between two intervals, so each call moves a
+// message from one bucket to another
+static void BM_SetMessageIntervalChanged(benchmark::State& state)
+{
+    uint8_t i = 0;
+    bool fast = false;
+    while (state.KeepRunning()) {
+        MAV_RESULT ret = link.set_message_interval(mavlink_ids[i], fast ? 50000 : 200000);
+        gbenchmark_escape(&ret);
+        i++;
+        if (i == ARRAY_SIZE(mavlink_ids)) {
+            i = 0;
+            fast = !fast;
+        }
+    }
+}
+
+BENCHMARK(BM_SetMessageIntervalUnchanged);
+BENCHMARK(BM_SetMessageIntervalChanged);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+#include <GCS_MAVLink/MAVLink_routing_loop.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint32_t msgid_attitude = 30;
+
+// a packet coming back on the channel it was forwarded from is dropped
+TEST(MAVLinkRoutingLoop, LoopedPacketDropped)
+{
+    MAVLink_routing_loop_cache cache {};
+    EXPECT_FALSE(cache.forwarded_recently(0, 1, 1, 42, msgid_attitude, 1000, 20));
+    EXPECT_TRUE(cache.forwarded_recently(0, 1, 1, 42, msgid_attitude, 1010, 20));
+    EXPECT_EQ(cache.drops(), 1U);
+    // outside the window it is a new packet
+    EXPECT_FALSE(cache.forwarded_recently(0, 1, 1, 42, msgid_attitude, 1040, 20));
+}
+
+// the same packet arriving over redundant links is forwarded from each
+TEST(MAVLinkRoutingLoop, RedundantLinks)
+{
+    MAVLink_routing_loop_cache cache {};
+    EXPECT_FALSE(cache.forwarded_recently(0, 255, 190, 7, msgid_attitude, 1000, 20));
+    EXPECT_FALSE(cache.forwarded_recently(1, 255, 190, 7, msgid_attitude, 1002, 20));
+    EXPECT_EQ(cache.drops(), 0U);
+}
+
+// a sender fast enough to wrap its sequence number well inside the
+// default loop timeout never has a packet mistaken for a looped one
+TEST(MAVLinkRoutingLoop, HighRateSeqWrap)
+{
+    MAVLink_routing_loop_cache cache {};
+    MAVLink_routing_seq_wrap seq_wrap {};
+    EXPECT_EQ(seq_wrap.loop_window_ms(), MAVLink_routing_seq_wrap::unknown_rate_window_ms);
+
+    // 2kHz, so seq wraps every 128ms
+    for (uint32_t i=0; i<4000; i++) {
+        const uint16_t now_ms = 1000 + i/2;
+        const uint8_t seq = i & 0xFF;
+        seq_wrap.update(seq, now_ms);
+        EXPECT_FALSE(cache.forwarded_recently(2, 1, 1, seq, msgid_attitude, now_ms, seq_wrap.loop_window_ms()));
+    }
+    EXPECT_EQ(cache.drops(), 0U);
+    EXPECT_LE(seq_wrap.loop_window_ms(), 128U/4);
+    EXPECT_GT(seq_wrap.loop_window_ms(), 0U);
+}
+
+// a low rate sender which doesn't increment its sequence number, as
+// some simple devices do with their heartbeats, is not suppressed
+TEST(MAVLinkRoutingLoop, FixedSeqPeriodic)
+{
+    MAVLink_routing_loop_cache cache {};
+    MAVLink_routing_seq_wrap seq_wrap {};
+    for (uint16_t i=0; i<10; i++) {
+        const uint16_t now_ms = 1000 + i*1000;
+        seq_wrap.update(0, now_ms);
+        EXPECT_FALSE(cache.forwarded_recently(0, 3, 1, 0, msgid_attitude, now_ms, seq_wrap.loop_window_ms()));
+    }
+    EXPECT_EQ(cache.drops(), 0U);
+}
+
+/*
+  handle a packet arriving on chan as check_and_forward does, returns
+  true if it is dropped as looped
+ */
+static bool arrive(MAVLink_routing_loop_cache &cache, MAVLink_routing_seq_wrap &seq_wrap,
+                   uint8_t chan, uint8_t seq, uint16_t now_ms)
+{
+    if (!cache.seen_recently(chan, 255, 190, seq, msgid_attitude, now_ms, seq_wrap.loop_window_ms())) {
+        seq_wrap.update(seq, now_ms);
+    }
+    return cache.forwarded_recently(chan, 255, 190, seq, msgid_attitude, now_ms, seq_wrap.loop_window_ms());
+}
+
+// looped copies of a sender's packets arriving between its new
+// packets are all dropped, and don't upset the sender's wrap period
+TEST(MAVLinkRoutingLoop, LoopedDuplicatesInterleaved)
+{
+    MAVLink_routing_loop_cache cache {};
+    MAVLink_routing_seq_wrap seq_wrap {};
+
+    // 50Hz sender, each packet comes back round a radio loop 70ms
+    // later, so up to four new packets arrive before its copy
+    const uint16_t interval_ms = 20;
+    const uint16_t loop_delay_ms = 70;
+    const uint16_t num_msgs = 1000;
+    uint16_t next_loop = 0;
+    for (uint16_t i=0; i<num_msgs; i++) {
+        const uint16_t now_ms = 1000 + i*interval_ms;
+        // copies due back before this packet
+        while (next_loop < i && 1000 + next_loop*interval_ms + loop_delay_ms <= now_ms) {
+            EXPECT_TRUE(arrive(cache, seq_wrap, 0, next_loop & 0xFF, 1000 + next_loop*interval_ms + loop_delay_ms));
+            next_loop++;
+        }
+        EXPECT_FALSE(arrive(cache, seq_wrap, 0, i & 0xFF, now_ms));
+    }
+    EXPECT_EQ(cache.drops(), uint32_t(next_loop));
+    EXPECT_GT(next_loop, num_msgs - 5);
+    // wraps every 5.12s, so the full loop timeout applies
+    EXPECT_EQ(seq_wrap.loop_window_ms(), 200U);
+}
+
+AP_GTEST_MAIN()